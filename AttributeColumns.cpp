@@ -0,0 +1,429 @@
+#include "AttributeColumns.h"
+
+using namespace std;
+
+AttributeColumns::AttributeColumns()
+{
+    _size = 0;
+    _hasRestrictions = false;
+    _isView = false;
+}
+
+void AttributeColumns::setDef(const AttributesDef &def)
+{
+    _size = 0;
+    _isView = false;
+    _viewFile.reset();
+    _hasRestrictions = false;
+    _intCols.assign(def.numIntValues(), vector<int>());
+    _floatCols.assign(def.numFloatValues(), vector<float>());
+    _stringCols.assign(def.numStringValues(), vector<int>());
+    _dicts.assign(def.numStringValues(), vector<string>());
+    _dictMaps.assign(def.numStringValues(), unordered_map<string,int>());
+    _intRestricts.clear();
+    _floatRestricts.clear();
+    _stringRestricts.clear();
+}
+
+int AttributeColumns::internString(int k, const std::string &value)
+{
+    unordered_map<string,int> &dictMap = _dictMaps[k];
+    auto iter = dictMap.find(value);
+    if(iter != dictMap.end())
+        return iter->second;
+    int code = _dicts[k].size();
+    _dicts[k].push_back(value);
+    dictMap[value] = code;
+    return code;
+}
+
+int AttributeColumns::findStringCode(int k, const std::string &value) const
+{
+    const unordered_map<string,int> &dictMap = _dictMaps[k];
+    auto iter = dictMap.find(value);
+    if(iter == dictMap.end())
+        return -1;
+    return iter->second;
+}
+
+void AttributeColumns::addRestrictionColumns()
+{
+    // Every row so far has been an exact value
+    _hasRestrictions = true;
+    _intRestricts.assign(_intCols.size(), vector<IntRestrictions>(_size));
+    _floatRestricts.assign(_floatCols.size(), vector<FloatRestrictions>(_size));
+    _stringRestricts.assign(_stringCols.size(), vector<StringRestrictions>(_size));
+}
+
+void AttributeColumns::add(const Attributes &a)
+{
+    if(_isView)
+        this->copyView();
+    const auto &ints = a.intValues();
+    const auto &floats = a.floatValues();
+    const auto &strings = a.stringValues();
+    if(ints.size() != _intCols.size() || floats.size() != _floatCols.size() || strings.size() != _stringCols.size())
+        throw "Can't add attributes. Number of attributes of each type doesn't match the columns.";
+
+    for(int k=0; k<ints.size(); k++)
+        _intCols[k].push_back(ints[k]);
+    for(int k=0; k<floats.size(); k++)
+        _floatCols[k].push_back((float)floats[k]);
+    for(int k=0; k<strings.size(); k++)
+        _stringCols[k].push_back(internString(k, strings[k]));
+
+    // Only start keeping track of restrictions once we actually see one
+    if(!_hasRestrictions)
+    {
+        bool exact = true;
+        for(const IntRestrictions &r : a.intRestrictions())
+            exact = exact && r.exact();
+        for(const FloatRestrictions &r : a.floatRestrictions())
+            exact = exact && r.exact();
+        for(const StringRestrictions &r : a.stringRestrictions())
+            exact = exact && r.exact();
+        if(!exact)
+            addRestrictionColumns();
+    }
+    if(_hasRestrictions)
+    {
+        for(int k=0; k<ints.size(); k++)
+            _intRestricts[k].push_back(a.intRestrictions()[k]);
+        for(int k=0; k<floats.size(); k++)
+            _floatRestricts[k].push_back(a.floatRestrictions()[k]);
+        for(int k=0; k<strings.size(); k++)
+            _stringRestricts[k].push_back(a.stringRestrictions()[k]);
+    }
+    _size++;
+}
+
+void AttributeColumns::set(int row, const Attributes &a)
+{
+    if(_isView)
+        this->copyView();
+    const auto &ints = a.intValues();
+    const auto &floats = a.floatValues();
+    const auto &strings = a.stringValues();
+    if(ints.size() != _intCols.size() || floats.size() != _floatCols.size() || strings.size() != _stringCols.size())
+        throw "Can't set attributes. Number of attributes of each type doesn't match the columns.";
+
+    for(int k=0; k<ints.size(); k++)
+        _intCols[k][row] = ints[k];
+    for(int k=0; k<floats.size(); k++)
+        _floatCols[k][row] = (float)floats[k];
+    for(int k=0; k<strings.size(); k++)
+        _stringCols[k][row] = internString(k, strings[k]);
+
+    if(!_hasRestrictions)
+    {
+        bool exact = true;
+        for(const IntRestrictions &r : a.intRestrictions())
+            exact = exact && r.exact();
+        for(const FloatRestrictions &r : a.floatRestrictions())
+            exact = exact && r.exact();
+        for(const StringRestrictions &r : a.stringRestrictions())
+            exact = exact && r.exact();
+        if(!exact)
+            addRestrictionColumns();
+    }
+    if(_hasRestrictions)
+    {
+        for(int k=0; k<ints.size(); k++)
+            _intRestricts[k][row] = a.intRestrictions()[k];
+        for(int k=0; k<floats.size(); k++)
+            _floatRestricts[k][row] = a.floatRestrictions()[k];
+        for(int k=0; k<strings.size(); k++)
+            _stringRestricts[k][row] = a.stringRestrictions()[k];
+    }
+}
+
+void AttributeColumns::addDefault()
+{
+    if(_isView)
+        this->copyView();
+    for(vector<int> &col : _intCols)
+        col.push_back(0);
+    for(vector<float> &col : _floatCols)
+        col.push_back(0.0f);
+    for(int k=0; k<_stringCols.size(); k++)
+        _stringCols[k].push_back(internString(k, string()));
+    if(_hasRestrictions)
+    {
+        for(auto &col : _intRestricts)
+            col.push_back(IntRestrictions());
+        for(auto &col : _floatRestricts)
+            col.push_back(FloatRestrictions());
+        for(auto &col : _stringRestricts)
+            col.push_back(StringRestrictions());
+    }
+    _size++;
+}
+
+void AttributeColumns::resize(int n)
+{
+    while(_size < n)
+        addDefault();
+}
+
+void AttributeColumns::clear()
+{
+    if(_isView)
+        this->copyView();
+    _size = 0;
+    for(vector<int> &col : _intCols)
+        col.clear();
+    for(vector<float> &col : _floatCols)
+        col.clear();
+    for(vector<int> &col : _stringCols)
+        col.clear();
+    for(auto &col : _intRestricts)
+        col.clear();
+    for(auto &col : _floatRestricts)
+        col.clear();
+    for(auto &col : _stringRestricts)
+        col.clear();
+}
+
+void AttributeColumns::removeFirst(int n)
+{
+    if(_isView)
+        this->copyView();
+    _size -= n;
+    for(vector<int> &col : _intCols)
+        col.erase(col.begin(), col.begin() + n);
+    for(vector<float> &col : _floatCols)
+        col.erase(col.begin(), col.begin() + n);
+    for(vector<int> &col : _stringCols)
+        col.erase(col.begin(), col.begin() + n);
+    for(auto &col : _intRestricts)
+        col.erase(col.begin(), col.begin() + n);
+    for(auto &col : _floatRestricts)
+        col.erase(col.begin(), col.begin() + n);
+    for(auto &col : _stringRestricts)
+        col.erase(col.begin(), col.begin() + n);
+}
+
+Attributes AttributeColumns::get(int row) const
+{
+    Attributes a;
+    for(int k=0; k<_stringCols.size(); k++)
+    {
+        const StringRestrictions &r = stringRestriction(k, row);
+        if(r.exact())
+            a.addStringValue(stringAt(k, row));
+        else
+            a.addStringValue(r);
+    }
+    for(int k=0; k<_floatCols.size(); k++)
+    {
+        const FloatRestrictions &r = floatRestriction(k, row);
+        if(r.exact())
+            a.addFloatValue(floatColumn(k)[row]);
+        else
+            a.addFloatValue(r);
+    }
+    for(int k=0; k<_intCols.size(); k++)
+    {
+        const IntRestrictions &r = intRestriction(k, row);
+        if(r.exact())
+            a.addIntValue(intColumn(k)[row]);
+        else
+            a.addIntValue(r);
+    }
+    return a;
+}
+
+void AttributeColumns::copyRow(const AttributeColumns &src, int row)
+{
+    if(src._hasRestrictions)
+    {
+        this->add(src.get(row));
+        return;
+    }
+    if(_isView)
+        this->copyView();
+    for(int k=0; k<_intCols.size(); k++)
+        _intCols[k].push_back(src.intColumn(k)[row]);
+    for(int k=0; k<_floatCols.size(); k++)
+        _floatCols[k].push_back(src.floatColumn(k)[row]);
+    for(int k=0; k<_stringCols.size(); k++)
+        _stringCols[k].push_back(internString(k, src.stringAt(k, row)));
+    if(_hasRestrictions)
+    {
+        for(auto &col : _intRestricts)
+            col.push_back(IntRestrictions());
+        for(auto &col : _floatRestricts)
+            col.push_back(FloatRestrictions());
+        for(auto &col : _stringRestricts)
+            col.push_back(StringRestrictions());
+    }
+    _size++;
+}
+
+void AttributeColumns::append(const AttributeColumns &src)
+{
+    if(src._intCols.size() != _intCols.size() || src._floatCols.size() != _floatCols.size() || src._stringCols.size() != _stringCols.size())
+        throw "Can't append attributes. Number of attributes of each type doesn't match the columns.";
+    if(src._hasRestrictions)
+    {
+        for(int row=0; row<src._size; row++)
+            this->add(src.get(row));
+        return;
+    }
+    if(_isView)
+        this->copyView();
+    int n = src._size;
+    for(int k=0; k<_intCols.size(); k++)
+        _intCols[k].insert(_intCols[k].end(), src.intColumn(k), src.intColumn(k) + n);
+    for(int k=0; k<_floatCols.size(); k++)
+        _floatCols[k].insert(_floatCols[k].end(), src.floatColumn(k), src.floatColumn(k) + n);
+    for(int k=0; k<_stringCols.size(); k++)
+    {
+        // Translate each of the source's codes once
+        vector<int> codes(src.numStringValues(k));
+        for(int code=0; code<codes.size(); code++)
+            codes[code] = internString(k, src.stringValue(k, code));
+        const int *from = src.stringColumn(k);
+        vector<int> &to = _stringCols[k];
+        for(int i=0; i<n; i++)
+            to.push_back(codes[from[i]]);
+    }
+    if(_hasRestrictions)
+    {
+        for(auto &col : _intRestricts)
+            col.resize(col.size() + n);
+        for(auto &col : _floatRestricts)
+            col.resize(col.size() + n);
+        for(auto &col : _stringRestricts)
+            col.resize(col.size() + n);
+    }
+    _size += n;
+}
+
+void AttributeColumns::gather(const AttributeColumns &src, const vector<int> &order, int start)
+{
+    int n = order.size();
+    if(start > 0 && _isView)
+        this->copyView();
+    _isView = false;
+    _viewFile.reset();
+    _intCols.resize(src._intCols.size());
+    _floatCols.resize(src._floatCols.size());
+    _stringCols.resize(src._stringCols.size());
+    // Same dictionaries, so the string codes can be copied as is
+    _dicts = src._dicts;
+    _dictMaps = src._dictMaps;
+    for(int k=0; k<_intCols.size(); k++)
+    {
+        const int *from = src.intColumn(k);
+        vector<int> &to = _intCols[k];
+        to.resize(n);
+        for(int i=start; i<n; i++)
+            to[i] = from[order[i]];
+    }
+    for(int k=0; k<_floatCols.size(); k++)
+    {
+        const float *from = src.floatColumn(k);
+        vector<float> &to = _floatCols[k];
+        to.resize(n);
+        for(int i=start; i<n; i++)
+            to[i] = from[order[i]];
+    }
+    for(int k=0; k<_stringCols.size(); k++)
+    {
+        const int *from = src.stringColumn(k);
+        vector<int> &to = _stringCols[k];
+        to.resize(n);
+        for(int i=start; i<n; i++)
+            to[i] = from[order[i]];
+    }
+    _size = n;
+    // (Only query graphs have restrictions, so they're just redone)
+    _hasRestrictions = src._hasRestrictions;
+    _intRestricts.clear();
+    _floatRestricts.clear();
+    _stringRestricts.clear();
+    if(_hasRestrictions)
+    {
+        addRestrictionColumns();
+        for(int k=0; k<_intRestricts.size(); k++)
+            for(int i=0; i<n; i++)
+                _intRestricts[k][i] = src._intRestricts[k][order[i]];
+        for(int k=0; k<_floatRestricts.size(); k++)
+            for(int i=0; i<n; i++)
+                _floatRestricts[k][i] = src._floatRestricts[k][order[i]];
+        for(int k=0; k<_stringRestricts.size(); k++)
+            for(int i=0; i<n; i++)
+                _stringRestricts[k][i] = src._stringRestricts[k][order[i]];
+    }
+}
+
+const IntRestrictions &AttributeColumns::intRestriction(int k, int row) const
+{
+    static const IntRestrictions EXACT;
+    if(!_hasRestrictions)
+        return EXACT;
+    return _intRestricts[k][row];
+}
+
+const FloatRestrictions &AttributeColumns::floatRestriction(int k, int row) const
+{
+    static const FloatRestrictions EXACT;
+    if(!_hasRestrictions)
+        return EXACT;
+    return _floatRestricts[k][row];
+}
+
+const StringRestrictions &AttributeColumns::stringRestriction(int k, int row) const
+{
+    static const StringRestrictions EXACT;
+    if(!_hasRestrictions)
+        return EXACT;
+    return _stringRestricts[k][row];
+}
+
+void AttributeColumns::setView(shared_ptr<MappedFile> file, int n, const vector<const int*> &ints,
+                               const vector<const float*> &floats, const vector<const int*> &strings,
+                               const vector<vector<string>> &dicts)
+{
+    if(ints.size() != _intCols.size() || floats.size() != _floatCols.size() || strings.size() != _stringCols.size())
+        throw "Can't use attribute columns. Number of attributes of each type doesn't match the definition.";
+    for(auto &col : _intCols)
+        col.clear();
+    for(auto &col : _floatCols)
+        col.clear();
+    for(auto &col : _stringCols)
+        col.clear();
+    _hasRestrictions = false;
+    _intRestricts.clear();
+    _floatRestricts.clear();
+    _stringRestricts.clear();
+    _dicts = dicts;
+    for(int k=0; k<_dicts.size(); k++)
+    {
+        _dictMaps[k].clear();
+        for(int code=0; code<_dicts[k].size(); code++)
+            _dictMaps[k][_dicts[k][code]] = code;
+    }
+    _isView = true;
+    _viewFile = file;
+    _intViews = ints;
+    _floatViews = floats;
+    _stringViews = strings;
+    _size = n;
+}
+
+void AttributeColumns::copyView()
+{
+    for(int k=0; k<_intCols.size(); k++)
+        _intCols[k].assign(_intViews[k], _intViews[k] + _size);
+    for(int k=0; k<_floatCols.size(); k++)
+        _floatCols[k].assign(_floatViews[k], _floatViews[k] + _size);
+    for(int k=0; k<_stringCols.size(); k++)
+        _stringCols[k].assign(_stringViews[k], _stringViews[k] + _size);
+    _isView = false;
+    _viewFile.reset();
+    _intViews.clear();
+    _floatViews.clear();
+    _stringViews.clear();
+}
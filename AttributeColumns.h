@@ -0,0 +1,126 @@
+#ifndef ATTRIBUTE_COLUMNS_H
+#define ATTRIBUTE_COLUMNS_H
+
+#include "Attributes.h"
+#include "AttributesDef.h"
+#include "MappedFile.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Column-oriented storage for the DATA attributes of every node (or every
+ * edge) in a graph.  Each attribute gets its own contiguous array, so a
+ * filter can test one attribute over a whole block of rows at a time.
+ * String attributes are stored as integer codes into a per-column
+ * dictionary of unique values.
+ *
+ * Restrictions (e.g., ">30" or a blank value in a query graph) are only
+ * stored once a row actually uses one, so large data graphs pay nothing
+ * for them.
+ *
+ * The columns can also be a read-only view of arrays in a mapped snapshot
+ * file (see setView()).  They're copied into regular vectors the first time
+ * anything modifies them.
+ */
+class AttributeColumns
+{
+public:
+    AttributeColumns();
+    /** Sets the definition, which determines the number of columns of each type.
+     * Any existing rows are cleared. */
+    void setDef(const AttributesDef &def);
+    /** Appends a row with the given attribute values (and restrictions). */
+    void add(const Attributes &a);
+    /** Replaces the values (and restrictions) of an existing row. */
+    void set(int row, const Attributes &a);
+    /** Appends a row of default values (0 or blank string) */
+    void addDefault();
+    /** Makes sure there are at least n rows, adding default rows as needed. */
+    void resize(int n);
+    /** Removes all rows (but keeps the column layout and dictionaries). */
+    void clear();
+    /** Removes the first n rows (the dictionaries keep their values). */
+    void removeFirst(int n);
+    /** Number of rows (nodes or edges) stored */
+    int size() const { return _size; }
+    /** Recreates the Attributes object for the given row */
+    Attributes get(int row) const;
+    /** Appends the given row from another set of columns with the same layout */
+    void copyRow(const AttributeColumns &src, int row);
+    /** Appends all the rows from another set of columns with the same layout
+     * (its string codes are translated to this dictionary). */
+    void append(const AttributeColumns &src);
+    /** Replaces the contents with the rows of src, in the given order
+     * (i.e., new row i is src row order[i]).  Rows before start are assumed
+     * to already be in place, and are kept as is.  This must use the same
+     * dictionaries as src (or a prefix of them, if src has added values since). */
+    void gather(const AttributeColumns &src, const std::vector<int> &order, int start = 0);
+
+    int numIntColumns() const { return _intCols.size(); }
+    int numFloatColumns() const { return _floatCols.size(); }
+    int numStringColumns() const { return _stringCols.size(); }
+    /** Values of the k-th INT attribute (one for each row) */
+    const int *intColumn(int k) const { return _isView ? _intViews[k] : _intCols[k].data(); }
+    /** Values of the k-th FLOAT attribute (one for each row) */
+    const float *floatColumn(int k) const { return _isView ? _floatViews[k] : _floatCols[k].data(); }
+    /** Dictionary codes of the k-th VARCHAR attribute (one for each row) */
+    const int *stringColumn(int k) const { return _isView ? _stringViews[k] : _stringCols[k].data(); }
+    /** Number of unique values of the k-th VARCHAR attribute */
+    int numStringValues(int k) const { return _dicts[k].size(); }
+    /** Gets the string for the given code of the k-th VARCHAR attribute */
+    const std::string &stringValue(int k, int code) const { return _dicts[k][code]; }
+    /** Gets the string value of the k-th VARCHAR attribute for the given row */
+    const std::string &stringAt(int k, int row) const { return _dicts[k][stringColumn(k)[row]]; }
+    /** Returns the code of the given string in the k-th VARCHAR dictionary, or -1 if it never occurs */
+    int findStringCode(int k, const std::string &value) const;
+
+    /** True if any row has a non-exact restriction */
+    bool hasRestrictions() const { return _hasRestrictions; }
+    /** Restriction on the k-th INT attribute for the given row */
+    const IntRestrictions &intRestriction(int k, int row) const;
+    /** Restriction on the k-th FLOAT attribute for the given row */
+    const FloatRestrictions &floatRestriction(int k, int row) const;
+    /** Restriction on the k-th VARCHAR attribute for the given row */
+    const StringRestrictions &stringRestriction(int k, int row) const;
+
+    /**
+     * Uses columns stored in a mapped file, replacing any existing rows.
+     * The number of columns of each type must match the definition.
+     * @param file  File the data is in (kept open as long as the columns are used).
+     * @param n  Number of rows.
+     * @param ints  Values for each INT column.
+     * @param floats  Values for each FLOAT column.
+     * @param strings  Dictionary codes for each VARCHAR column.
+     * @param dicts  Dictionary of unique values for each VARCHAR column.
+     */
+    void setView(std::shared_ptr<MappedFile> file, int n, const std::vector<const int*> &ints,
+                 const std::vector<const float*> &floats, const std::vector<const int*> &strings,
+                 const std::vector<std::vector<std::string>> &dicts);
+
+private:
+    int internString(int k, const std::string &value);
+    void addRestrictionColumns();
+    /** Copies the columns out of the mapped file, so they can be modified */
+    void copyView();
+
+    int _size;
+    // Columns in a mapped file, if used
+    bool _isView;
+    std::shared_ptr<MappedFile> _viewFile;
+    std::vector<const int*> _intViews;
+    std::vector<const float*> _floatViews;
+    std::vector<const int*> _stringViews;
+    std::vector<std::vector<int>> _intCols;
+    std::vector<std::vector<float>> _floatCols;
+    std::vector<std::vector<int>> _stringCols;
+    std::vector<std::vector<std::string>> _dicts;
+    std::vector<std::unordered_map<std::string,int>> _dictMaps;
+    bool _hasRestrictions;
+    std::vector<std::vector<IntRestrictions>> _intRestricts;
+    std::vector<std::vector<FloatRestrictions>> _floatRestricts;
+    std::vector<std::vector<StringRestrictions>> _stringRestricts;
+};
+
+#endif
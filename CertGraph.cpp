@@ -1,5 +1,6 @@
 #include "CertGraph.h"
 #include "GraphMatch.h"
+#include <algorithm>
 #include <iostream>
 #include <unordered_set>
 
@@ -24,12 +25,19 @@ void CertGraph::addLabeledNode(int v, std::string label)
     int n = this->nodes().size();
     if(n > this->_nodeTypes.size())
     {        
-        _nodeTypes.resize(n);
-        _nodeOutEdgeTypes.resize(n);
-        _nodeInEdgeTypes.resize(n);
+        this->resizeNodeTypes(n);
         //_nodeWeights.resize(n,0.0);        
     }
 }
+
+void CertGraph::resizeNodeTypes(int n)
+{
+    _nodeTypes.resize(n, 0);
+    _nodeOutEdgeTypes.resize(n, 0);
+    _nodeInEdgeTypes.resize(n, 0);
+    _nodeOutOverflowTypes.resize(n);
+    _nodeInOverflowTypes.resize(n);
+}
  
 void CertGraph::addEdge(int u, int v, time_t dateTime)
 {
@@ -37,7 +45,9 @@ void CertGraph::addEdge(int u, int v, time_t dateTime)
         
     // Call base class
     LabeledWeightedGraph::addEdge(u, v, dateTime);    
-    this->_timeEdgeTypeMap[dateTime].push_back("");
+    _insertedEdgeTypes.push_back(0);
+    if(_edgesReady)
+        this->appendOrderedType(numEdges()-1, 0);
 }
     
 void CertGraph::addWeightedEdge(int u, int v, time_t dateTime, double weight)
@@ -46,7 +56,9 @@ void CertGraph::addWeightedEdge(int u, int v, time_t dateTime, double weight)
         
     // Call base class
     LabeledWeightedGraph::addWeightedEdge(u, v, dateTime, weight);
-    this->_timeEdgeTypeMap[dateTime].push_back("");
+    _insertedEdgeTypes.push_back(0);
+    if(_edgesReady)
+        this->appendOrderedType(numEdges()-1, 0);
 }
     
 void CertGraph::copyEdge(int edgeIndex, const Graph &g)
@@ -66,6 +78,45 @@ void CertGraph::copyEdge(int edgeIndex, const Graph &g)
     this->addEdge(u, v, edge.time(), cg.getEdgeType(edgeIndex)); 
 }
 
+void CertGraph::renumberNodes(const vector<int> &order)
+{
+    LabeledWeightedGraph::renumberNodes(order);
+
+    reorderNodeValues(_nodeTypes, order);
+    for(auto *typeDegs : {&_typeOutDegs, &_typeInDegs})
+    {
+        // (types without edges don't have a list)
+        for(vector<int> &degs : *typeDegs)
+        {
+            if(!degs.empty())
+                reorderNodeValues(degs, order);
+        }
+    }
+    reorderNodeValues(_nodeOutEdgeTypes, order);
+    reorderNodeValues(_nodeInEdgeTypes, order);
+    reorderNodeValues(_nodeOutOverflowTypes, order);
+    reorderNodeValues(_nodeInOverflowTypes, order);
+    reorderNodeValues(_nodeTypedOutEdges, order);
+    reorderNodeValues(_nodeTypedInEdges, order);
+
+    // The restrictions are kept by node index
+    vector<int> newIds(order.size());
+    for(int i=0; i<order.size(); i++)
+        newIds[order[i]] = i;
+    unordered_map<int,vector<DegRestriction>> degRestricts;
+    for(auto &restricts : _degRestricts)
+        degRestricts[newIds[restricts.first]].swap(restricts.second);
+    _degRestricts.swap(degRestricts);
+    unordered_set<int> needsNameMatch;
+    for(int v : _needsNameMatch)
+        needsNameMatch.insert(newIds[v]);
+    _needsNameMatch.swap(needsNameMatch);
+    unordered_map<int,pair<string,regex>> regexMatch;
+    for(auto &match : _regexMatch)
+        regexMatch.insert(make_pair(newIds[match.first], match.second));
+    _regexMatch.swap(regexMatch);
+}
+
 CertGraph CertGraph::createSubGraph(const vector<int> &edges)
 {    
     CertGraph g(this->windowDuration());
@@ -225,14 +276,12 @@ void CertGraph::addTypedNode(const std::string &name, const std::string &type) /
         if(v >= this->_nodeTypes.size())
         {        
             //cout << "resizing node types" << endl;
-            _nodeTypes.resize(v+1);
+            this->resizeNodeTypes(v+1);
             //_nodeWeights.resize(n,0.0);        
-            _nodeOutEdgeTypes.resize(v+1);
-            _nodeInEdgeTypes.resize(v+1);
         }
         //cout << "v = " << v << endl;
         //cout << "setting nodetypes" << endl;
-        _nodeTypes[v] = type;
+        _nodeTypes[v] = TypeDictionary::id(type);
         //cout << "nodeTypes[v] = " << _nodeTypes[v] << endl;
         //_nodeWeights[v] = weight;
     }
@@ -255,11 +304,20 @@ void CertGraph::addEdge(const std::string &source, const std::string &dest, time
 void CertGraph::addEdge(int u, int v, time_t dateTime, const std::string &type)
 {    
     LabeledWeightedGraph::addEdge(u, v, dateTime);
-    _timeEdgeTypeMap[dateTime].push_back(type);
+    int typeId = TypeDictionary::id(type);
+    _insertedEdgeTypes.push_back(typeId);
+    // Edges added in order can go straight into the typed lists
+    if(_edgesReady)
+        this->appendOrderedType(numEdges()-1, typeId);
     
     // Get degrees for this edge type
-    vector<int> &outDegs = _typeOutDegs[type];
-    vector<int> &inDegs = _typeInDegs[type];
+    if(typeId >= _typeOutDegs.size())
+    {
+        _typeOutDegs.resize(typeId+1);
+        _typeInDegs.resize(typeId+1);
+    }
+    vector<int> &outDegs = _typeOutDegs[typeId];
+    vector<int> &inDegs = _typeInDegs[typeId];
     
     // Update size of mapping, if needed
     int n = this->nodes().size();
@@ -269,21 +327,32 @@ void CertGraph::addEdge(int u, int v, time_t dateTime, const std::string &type)
         inDegs.resize(n, 0);
     }
     
+    // Update sets of adjacent edge types
+    // (These allow quicker graph filtering)
+    if(n > _nodeOutEdgeTypes.size())
+        this->resizeNodeTypes(n);
+    int bit = TypeDictionary::maskBit(typeId);
+    _nodeOutEdgeTypes[u] |= 1ULL << bit;
+    _nodeInEdgeTypes[v] |= 1ULL << bit;
+    if(bit == TypeDictionary::OVERFLOW_BIT)
+    {
+        if(outDegs[u] == 0)
+            _nodeOutOverflowTypes[u].push_back(typeId);
+        if(inDegs[v] == 0)
+            _nodeInOverflowTypes[v].push_back(typeId);
+    }
+    
     // Increment degrees
     outDegs[u]++;
     inDegs[v]++;
-    
-    // Update sets of adjacent edge types
-    // (These allow quicker graph filtering)
-    if(u >= _nodeOutEdgeTypes.size())
-        _nodeOutEdgeTypes.resize(u+1);
-    _nodeOutEdgeTypes[u].insert(type);
-    if(v >= _nodeInEdgeTypes.size())
-        _nodeInEdgeTypes.resize(v+1);
-    _nodeInEdgeTypes[v].insert(type);
 }
 
 const std::string &CertGraph::getEdgeType(int edgeIndex) const
+{
+    return TypeDictionary::name(this->getEdgeTypeId(edgeIndex));
+}
+
+int CertGraph::getEdgeTypeId(int edgeIndex) const
 {
     if(_edgesReady == false)
     {
@@ -294,54 +363,128 @@ const std::string &CertGraph::getEdgeType(int edgeIndex) const
 
 int CertGraph::getOutDeg(int v, const std::string &edgeType) const
 {
-    const auto &pair = _typeOutDegs.find(edgeType);
-    if(pair == _typeOutDegs.end())
+    int typeId = TypeDictionary::find(edgeType);
+    if(typeId < 0)
         return 0;
-    else if(pair->second.size() <= v)
+    return this->getOutDeg(v, typeId);
+}
+
+int CertGraph::getOutDeg(int v, int edgeTypeId) const
+{
+    if(edgeTypeId >= _typeOutDegs.size())
         return 0;
-    else
-    {
-        //cout << pair->second[v] << endl;
-        return pair->second[v];        
-    }
+    const vector<int> &degs = _typeOutDegs[edgeTypeId];
+    if(degs.size() <= v)
+        return 0;
+    return degs[v];
 }
 
 int CertGraph::getInDeg(int v, const std::string &edgeType) const
 {
-    const auto &pair = _typeInDegs.find(edgeType);
-    if(pair == _typeInDegs.end())
+    int typeId = TypeDictionary::find(edgeType);
+    if(typeId < 0)
+        return 0;
+    return this->getInDeg(v, typeId);
+}
+
+int CertGraph::getInDeg(int v, int edgeTypeId) const
+{
+    if(edgeTypeId >= _typeInDegs.size())
         return 0;
-    else if(pair->second.size() <= v)
+    const vector<int> &degs = _typeInDegs[edgeTypeId];
+    if(degs.size() <= v)
         return 0;
-    else
-    {
-        //cout << pair->second[v] << endl;
-        return pair->second[v];        
-    }
+    return degs[v];
 }
 
-const unordered_set<string> &CertGraph::getOutEdgeTypes(int v) const 
+uint64_t CertGraph::getOutEdgeTypeMask(int v) const 
 { 
     if(v >= _nodeOutEdgeTypes.size())
     {
         cout << "Missing out edge types for vertex " << v << endl;
         throw "Missing out edge types for vertex.";
-        //_nodeOutEdgeTypes.resize(v+1);
     }
     return _nodeOutEdgeTypes[v]; 
 }
        
-const unordered_set<string> &CertGraph::getInEdgeTypes(int v) const 
+uint64_t CertGraph::getInEdgeTypeMask(int v) const 
 { 
     if(v >= _nodeInEdgeTypes.size())
     {
         cout << "Missing in edge types for vertex " << v << endl;
         throw "Missing in edge types for vertex.";
-        //_nodeInEdgeTypes.resize(v+1);
     }
     return _nodeInEdgeTypes[v]; 
 }
 
+const vector<int> &CertGraph::getTypedOutEdges(int v, int edgeTypeId) const
+{
+    if(_edgesReady == false)
+        this->updateOrderedEdges();
+    if(v >= _nodeTypedOutEdges.size())
+    {
+        // Node without any edges
+        static const vector<int> EMPTY;
+        return EMPTY;
+    }
+    return findTypedEdges(_nodeTypedOutEdges[v], edgeTypeId);
+}
+
+const vector<int> &CertGraph::getTypedInEdges(int v, int edgeTypeId) const
+{
+    if(_edgesReady == false)
+        this->updateOrderedEdges();
+    if(v >= _nodeTypedInEdges.size())
+    {
+        // Node without any edges
+        static const vector<int> EMPTY;
+        return EMPTY;
+    }
+    return findTypedEdges(_nodeTypedInEdges[v], edgeTypeId);
+}
+
+const vector<int> &CertGraph::getTypedEdges(int edgeTypeId) const
+{
+    static const vector<int> EMPTY;
+    if(_edgesReady == false)
+        this->updateOrderedEdges();
+    if(edgeTypeId >= _typedEdges.size())
+        return EMPTY;
+    return _typedEdges[edgeTypeId];
+}
+
+const vector<int> &CertGraph::findTypedEdges(const vector<pair<int,vector<int>>> &lists, int edgeTypeId)
+{
+    static const vector<int> EMPTY;
+    for(const auto &list : lists)
+    {
+        if(list.first == edgeTypeId)
+            return list.second;
+    }
+    return EMPTY;
+}
+
+vector<int> &CertGraph::addTypedEdges(vector<pair<int,vector<int>>> &lists, int edgeTypeId)
+{
+    for(auto &list : lists)
+    {
+        if(list.first == edgeTypeId)
+            return list.second;
+    }
+    lists.push_back(make_pair(edgeTypeId, vector<int>()));
+    return lists.back().second;
+}
+
+const vector<int> &CertGraph::getOutOverflowTypes(int v) const
+{
+    return _nodeOutOverflowTypes[v];
+}
+
+const vector<int> &CertGraph::getInOverflowTypes(int v) const
+{
+    return _nodeInOverflowTypes[v];
+}
+
 const vector<DegRestriction> &CertGraph::getDegRestrictions(int v) const
 {
     return this->_degRestricts.find(v)->second;
@@ -354,12 +497,14 @@ bool CertGraph::hasDegRestrictions(int v) const
 
 void CertGraph::addDegRestriction(int v, const DegRestriction &restrict)
 {
+    this->checkNotFrozen();
     this->_degRestricts[v].push_back(restrict);
 }
 
-void CertGraph::addRegex(int v, const std::regex &regex)
+void CertGraph::addRegex(int v, const std::string &pattern)
 {
-    _regexMatch[v] = regex;
+    this->checkNotFrozen();
+    _regexMatch[v] = make_pair(pattern, regex(pattern));
 }
 
 void CertGraph::disp() const
@@ -431,23 +576,143 @@ void CertGraph::disp(int edgeIndex) const
 
 void CertGraph::updateOrderedEdges() const
 {
-    //cout << "UPDATE ORDERED EDGES" << endl;
-    
     // Make sure base class is updated first
     LabeledWeightedGraph::updateOrderedEdges();
     
-    // Clear old edge weights
-    _edgeTypes.clear();
-    
-    // Build edge list in chronological order
-    for(auto &pair : _timeEdgeTypeMap)
+    const vector<int> &order = this->insertionOrder();
+    const EdgeList &edges = this->edges();
+    int m = order.size();
+    int start = this->reorderStart();
+    if(start == 0)
+    {
+        _edgeTypes.clear();
+        _nodeTypedOutEdges.clear();
+        _nodeTypedInEdges.clear();
+        _typedEdges.clear();
+    }
+    else
     {
-        time_t dateTime = pair.first;
-        const vector<string> &types = _timeEdgeTypeMap.find(dateTime)->second;
-        for(const string &type : types)
+        _nodeTypedOutEdges.resize(max(_nodeTypedOutEdges.size(), this->nodes().size()));
+        _nodeTypedInEdges.resize(_nodeTypedOutEdges.size());
+        _typedEdges.resize(max(_typedEdges.size(), (size_t)TypeDictionary::size()));
+        // The edges that moved are at the ends of the typed lists, and
+        // they're all still connected to the same nodes (at a later index)
+        for(int e=start; e<m; e++)
         {
-            //cout << "Adding edge type: " << type << endl;
-            _edgeTypes.push_back(type);
+            int type = _insertedEdgeTypes[order[e]];
+            vector<int> &outEdges = addTypedEdges(_nodeTypedOutEdges[edges[e].source()], type);
+            while(!outEdges.empty() && outEdges.back() >= start)
+                outEdges.pop_back();
+            vector<int> &inEdges = addTypedEdges(_nodeTypedInEdges[edges[e].dest()], type);
+            while(!inEdges.empty() && inEdges.back() >= start)
+                inEdges.pop_back();
+            vector<int> &typeEdges = _typedEdges[type];
+            while(!typeEdges.empty() && typeEdges.back() >= start)
+                typeEdges.pop_back();
         }
+        _edgeTypes.resize(start);
+    }
+
+    // Put the types in chronological order, partitioning the adjacency lists by type
+    for(int e=start; e<m; e++)
+        this->appendOrderedType(e, _insertedEdgeTypes[order[e]]);
+}
+
+void CertGraph::removeOldestEdges(int count)
+{
+    // Take the old edges out of the degrees and the sets of adjacent edge types
+    auto removeType = [](vector<vector<int>> &typeDegs, vector<uint64_t> &edgeTypes, 
+                         vector<vector<int>> &overflowTypes, int type, int v)
+    {
+        // (Edges added without a type aren't counted)
+        if(type >= typeDegs.size() || v >= typeDegs[type].size() || typeDegs[type][v] == 0)
+            return;
+        if(--typeDegs[type][v] > 0)
+            return;
+        int bit = TypeDictionary::maskBit(type);
+        if(bit == TypeDictionary::OVERFLOW_BIT)
+        {
+            vector<int> &types = overflowTypes[v];
+            types.erase(find(types.begin(), types.end(), type));
+            if(!types.empty())
+                return;
+        }
+        edgeTypes[v] &= ~(1ULL << bit);
+    };
+    const EdgeList &edges = this->edges();
+    for(int e=0; e<count; e++)
+    {
+        removeType(_typeOutDegs, _nodeOutEdgeTypes, _nodeOutOverflowTypes, _edgeTypes[e], edges[e].source());
+        removeType(_typeInDegs, _nodeInEdgeTypes, _nodeInOverflowTypes, _edgeTypes[e], edges[e].dest());
+    }
+
+    // The old edges are at the start of their nodes' typed lists
+    auto removeOld = [count](vector<pair<int,vector<int>>> &lists)
+    {
+        for(auto &list : lists)
+            removeOldEdges(list.second, count);
+        // Drop the types the node doesn't have anymore
+        lists.erase(remove_if(lists.begin(), lists.end(), 
+                              [](const pair<int,vector<int>> &list) { return list.second.empty(); }), lists.end());
+    };
+    for(int e=0; e<count; e++)
+    {
+        int u = edges[e].source(), v = edges[e].dest();
+        if(u < _nodeTypedOutEdges.size())
+            removeOld(_nodeTypedOutEdges[u]);
+        if(v < _nodeTypedInEdges.size())
+            removeOld(_nodeTypedInEdges[v]);
+    }
+    for(vector<int> &list : _typedEdges)
+        removeOldEdges(list, count);
+
+    LabeledWeightedGraph::removeOldestEdges(count);
+    _edgeTypes.erase(_edgeTypes.begin(), _edgeTypes.begin() + count);
+    _insertedEdgeTypes = _edgeTypes;
+
+    // Renumber the typed lists of the nodes that still have edges (once
+    // each, at their first edge)
+    const vector<Node> &nodes = this->nodes();
+    auto renumber = [&](int v, int e)
+    {
+        if(nodes[v].edges().front() != e || v >= _nodeTypedOutEdges.size())
+            return;
+        for(auto *lists : {&_nodeTypedOutEdges[v], &_nodeTypedInEdges[v]})
+        {
+            for(auto &list : *lists)
+            {
+                for(int &i : list.second)
+                    i -= count;
+            }
+        }
+    };
+    for(int e=0; e<edges.size(); e++)
+    {
+        int u = edges[e].source(), v = edges[e].dest();
+        renumber(u, e);
+        if(v != u)
+            renumber(v, e);
+    }
+    for(vector<int> &list : _typedEdges)
+    {
+        for(int &e : list)
+            e -= count;
+    }
+}
+
+void CertGraph::appendOrderedType(int e, int type) const
+{
+    const Edge &edge = this->edges()[e];
+    int n = this->nodes().size();
+    if(_nodeTypedOutEdges.size() < n)
+    {
+        _nodeTypedOutEdges.resize(n);
+        _nodeTypedInEdges.resize(n);
     }
+    if(_typedEdges.size() <= type)
+        _typedEdges.resize(type+1);
+    _edgeTypes.push_back(type);
+    addTypedEdges(_nodeTypedOutEdges[edge.source()], type).push_back(e);
+    addTypedEdges(_nodeTypedInEdges[edge.dest()], type).push_back(e);
+    _typedEdges[type].push_back(e);
 }
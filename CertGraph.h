@@ -13,6 +13,8 @@
 #include "GraphMatch.h"
 #include "DegRestriction.h" // Used for search graphs
 #include "Roles.h"
+#include "TypeDictionary.h"
+#include <stdint.h>
 #include <string>
 #include <time.h>
 #include <map> // For a red-black binary tree (sorting date/time)
@@ -56,6 +58,9 @@ public:
     void addEdge(int u, int v, time_t dateTime, const std::string &type);
     /** Overriding from base class. Copies the given edge from another PajekGraph, including weight information. */
     void copyEdge(int edgeIndex, const Graph &g) override;
+    /** Renumbers the nodes, moving their types, typed degrees and edge lists,
+     * and any restrictions, with them */
+    void renumberNodes(const std::vector<int> &order) override;
     /** Creates a new subgraph with just the given edges, and any adjoining nodes */
     CertGraph createSubGraph(const std::vector<int> &edges);
     /** Creates a new subgraph based on all of the given subgraphs.
@@ -73,25 +78,46 @@ public:
      */
     CertGraph createAggregateSubGraph(bool ignoreDir, const std::vector<GraphMatch> &subGraphs, std::vector<int> &edgeCounts);
     
+    /** Gets the type of node */
+    const std::string &getNodeType(int v) const { return TypeDictionary::name(_nodeTypes[v]); }
+    /** Gets the TypeDictionary ID of the node's type */
+    int getNodeTypeId(int v) const { return _nodeTypes[v]; }
     /** Gets the type of edge */
-    const std::string &getNodeType(int v) const { return _nodeTypes[v]; }
-    /** Gets weight associated with node */
     const std::string &getEdgeType(int edgeIndex) const;
+    /** Gets the TypeDictionary ID of the edge's type */
+    int getEdgeTypeId(int edgeIndex) const;
     /** Returns the number of outgoing edges adjacent to the node for the given edge type.
      * @param v  The index of the node.
      * @param edgeType  The type of edge. */
     int getOutDeg(int v, const std::string &edgeType) const;
+    /** Returns the number of outgoing edges adjacent to the node for the given edge type ID. */
+    int getOutDeg(int v, int edgeTypeId) const;
     /** Returns the number of incoming edges adjacent to the node for the given edge type.
      * @param v  The index of the node.
      * @param edgeType  The type of edge. */
     int getInDeg(int v, const std::string &edgeType) const;
+    /** Returns the number of incoming edges adjacent to the node for the given edge type ID. */
+    int getInDeg(int v, int edgeTypeId) const;
     
-    /** Gets the types used for out edges for the given node.
+    /** Gets the types used for out edges for the given node, as a mask with
+     * bit TypeDictionary::maskBit(id) set for each type.  Types with IDs past
+     * the overflow bit all share that bit, so use getOutDeg() for those.
      * @param v  Index of the node. */
-    const std::unordered_set<std::string> &getOutEdgeTypes(int v) const;
-    /** Gets the types used for in edges for the given node.
+    uint64_t getOutEdgeTypeMask(int v) const;
+    /** Gets the types used for in edges for the given node, as a mask
+     * (see getOutEdgeTypeMask()).
      * @param v  Index of the node. */
-    const std::unordered_set<std::string> &getInEdgeTypes(int v) const;
+    uint64_t getInEdgeTypeMask(int v) const;
+    /** Gets the IDs of out edge types that only have the shared overflow bit in the mask. */
+    const std::vector<int> &getOutOverflowTypes(int v) const;
+    /** Gets the IDs of in edge types that only have the shared overflow bit in the mask. */
+    const std::vector<int> &getInOverflowTypes(int v) const;
+    /** Gets the out edges of the node with the given edge type ID, in chronological order. */
+    const std::vector<int> &getTypedOutEdges(int v, int edgeTypeId) const;
+    /** Gets the in edges of the node with the given edge type ID, in chronological order. */
+    const std::vector<int> &getTypedInEdges(int v, int edgeTypeId) const;
+    /** Gets all edges with the given edge type ID, in chronological order. */
+    const std::vector<int> &getTypedEdges(int edgeTypeId) const;
     
     /** Displays all graph contents */
     void disp() const override;
@@ -116,7 +142,7 @@ public:
     bool needsNameMatch(int v) const { return _needsNameMatch.find(v) != _needsNameMatch.end(); }
     /** Requires that this node have its named match in a matching subgraph.
      * @param v  The index of the node. */
-    void setNeedsNameMatch(int v) { _needsNameMatch.insert(v); }
+    void setNeedsNameMatch(int v) { this->checkNotFrozen(); _needsNameMatch.insert(v); }
 
     /** Returns if the given node needs to have a regular expression match
     for the matching subgraph. 
@@ -124,30 +150,54 @@ public:
     * @return  True if the node needs to have a regular expression match in the subgraph. */
     bool needsRegexMatch(int v) const { return _regexMatch.find(v) != _regexMatch.end(); }
     /** Adds the given regular expression as a requirement for matching
-     * the given node in the subgraph.
+     * the given node in the subgraph (throws std::regex_error if it's not valid).
      * @param v  The index of the node.
-     * @param regex  Regular expression that needs to be matched in the subgraph. */
-    void addRegex(int v, const std::regex &regex);
+     * @param pattern  Regular expression that needs to be matched in the subgraph. */
+    void addRegex(int v, const std::string &pattern);
     /** Returns the regular expression needed for the given node (if it exists)
      * or throws an exception, if none is needed.
      * @param v  The index of the node.
      * @param return  The compiled regular expression. */
-    const std::regex &getRegex(int v) const { return _regexMatch.find(v)->second; }
+    const std::regex &getRegex(int v) const { return _regexMatch.find(v)->second.second; }
+    /** Returns the text of the regular expression needed for the given node
+     * (if it exists), as given to addRegex().
+     * @param v  The index of the node. */
+    const std::string &getRegexPattern(int v) const { return _regexMatch.find(v)->second.first; }
 protected:
     void updateOrderedEdges() const override;
+    void removeOldestEdges(int count) override;
     
 private:
-    std::vector<std::string> _nodeTypes;
-    std::unordered_map<std::string,std::vector<int>> _typeOutDegs, _typeInDegs;
+    /** Makes room for n nodes in the per-node type data */
+    void resizeNodeTypes(int n);
+    /** Finds the list for the given type in a node's typed edge lists */
+    static const std::vector<int> &findTypedEdges(const std::vector<std::pair<int,std::vector<int>>> &lists, int edgeTypeId);
+    /** Same as findTypedEdges(), but adds the list if it's not there */
+    static std::vector<int> &addTypedEdges(std::vector<std::pair<int,std::vector<int>>> &lists, int edgeTypeId);
+    /** Adds the type of the given edge (which was just put at the end of the
+     * chronological edge list) to the typed edge lists */
+    void appendOrderedType(int e, int type) const;
+
+    // Type ID of each node
+    std::vector<int> _nodeTypes;
+    // Degrees, indexed by [edge type ID][node]
+    std::vector<std::vector<int>> _typeOutDegs, _typeInDegs;
     std::unordered_map<int,std::vector<DegRestriction>> _degRestricts;
     std::unordered_set<int> _needsNameMatch;
-    std::unordered_map<int,std::regex> _regexMatch;
-    // Ordered map, by date/time
-    std::map<time_t,std::vector<std::string>> _timeEdgeTypeMap;
-    // Ordered list of edges for the graph
-    //mutable std::vector<Edge> _edges;
-    mutable std::vector<std::string> _edgeTypes;
-    std::vector<std::unordered_set<std::string>> _nodeOutEdgeTypes, _nodeInEdgeTypes;
+    // Pattern and compiled regular expression of each node that has one
+    std::unordered_map<int,std::pair<std::string,std::regex>> _regexMatch;
+    // Type ID of each edge, in the order they were added
+    std::vector<int> _insertedEdgeTypes;
+    // Type ID of each edge, in chronological order
+    mutable std::vector<int> _edgeTypes;
+    // Adjacent edge types of each node
+    std::vector<uint64_t> _nodeOutEdgeTypes, _nodeInEdgeTypes;
+    std::vector<std::vector<int>> _nodeOutOverflowTypes, _nodeInOverflowTypes;
+    // Chronological edge lists partitioned by edge type, for each node
+    // (each node only has a few types, so they're kept in small lists of (type ID, edges))
+    mutable std::vector<std::vector<std::pair<int,std::vector<int>>>> _nodeTypedOutEdges, _nodeTypedInEdges;
+    // Chronological edge lists for each edge type
+    mutable std::vector<std::vector<int>> _typedEdges;
 };
 
 #endif	/* CERTGRAPH_H */
@@ -1,5 +1,6 @@
 #include "CmdArgs.h"
 #include "FileIO.h"
+#include "NodeOrder.h"
 #include <iostream>
 
 using namespace std;
@@ -8,6 +9,8 @@ CmdArgs::CmdArgs(int argc, char **argv)
 {
     _success = true; // Unless proven otherwise
     _unordered = false; // By default, take chronological ordering into account
+    _explain = false;
+    _reorderBenchmark = false;
 
     if(argc <= 1)
     {
@@ -19,6 +22,9 @@ CmdArgs::CmdArgs(int argc, char **argv)
     for(int i=1; i<argc; i++)
     {
 	string arg = argv[i];
+	// Allow the GNU style "--" for any argument
+	if(arg.size() > 2 && arg[0] == '-' && arg[1] == '-')
+	    arg = arg.substr(1);
 	if(arg == "-g")
 	{
 	    i++;
@@ -78,6 +84,72 @@ CmdArgs::CmdArgs(int argc, char **argv)
 	    }
 	    _outFname = argv[i];
 	}
+	else if(arg == "-save-snapshot")
+	{
+	    i++;
+	    if(i == argc)
+	    {
+		cout << "Missing snapshot file after -save-snapshot argument." << endl;
+		_success = false;
+		continue;
+	    }
+	    _snapshotFname = argv[i];
+	}
+	else if(arg == "-stats")
+	{
+	    i++;
+	    if(i == argc)
+	    {
+		cout << "Missing statistics file after -stats argument." << endl;
+		_success = false;
+		continue;
+	    }
+	    _statsFname = argv[i];
+	}
+	else if(arg == "-stream")
+	{
+	    i++;
+	    if(i == argc)
+	    {
+		cout << "Missing config file after -stream argument." << endl;
+		_success = false;
+		continue;
+	    }
+	    _configFname = argv[i];
+	    if(FileIO::fileExists(_configFname)==false)
+	    {
+		cout << "Config file \"" << _configFname << "\" does not exist, or cannot be opened." << endl;
+		_success = false;
+	    }
+	}
+	else if(arg == "-explain")
+	{
+	    _explain = true;
+	}
+	else if(arg == "-reorder")
+	{
+	    i++;
+	    if(i == argc)
+	    {
+		cout << "Missing node order after -reorder argument." << endl;
+		_success = false;
+		continue;
+	    }
+	    _reorder = argv[i];
+	    try
+	    {
+		NodeOrder::parse(_reorder);
+	    }
+	    catch(const char *msg)
+	    {
+		cout << msg << endl;
+		_success = false;
+	    }
+	}
+	else if(arg == "-reorder-benchmark")
+	{
+	    _reorderBenchmark = true;
+	}
 	else if(arg == "-delta")
 	{
 	    i++;
@@ -110,7 +182,12 @@ CmdArgs::CmdArgs(int argc, char **argv)
 	cout << "Missing graph file. Specify with the -g argument." << endl;
 	_success = false;
     }
-    if(_queryFnames.empty())
+    if(_reorderBenchmark && _queryFnames.empty())
+    {
+	cout << "The -reorder-benchmark argument needs a query file (-q)." << endl;
+	_success = false;
+    }
+    if(_queryFnames.empty() && _snapshotFname.empty() && _statsFname.empty())
     {
 	cout << "Missing query file. Specify with the -q argument." << endl;
 	_success = false;
@@ -160,15 +237,49 @@ void CmdArgs::dispHelp() const
     cout << "       If no name is specified, then a default filename is used, based" << endl;
     cout << "       on the input filenames and the delta value used." << endl;
     cout << endl;
+    cout << "Snapshot arguments:" << endl;
+    cout << "  -save-snapshot [filename]" << endl;
+    cout << "       Saves the data graph (-g) as a binary snapshot, instead of searching." << endl;
+    cout << "       Snapshots can be used with -g in place of a GDF file, and load" << endl;
+    cout << "       almost instantly." << endl;
+    cout << endl;
+    cout << "Statistics arguments:" << endl;
+    cout << "  -stats [filename]" << endl;
+    cout << "       Saves statistics about the data graph (-g) as a JSON report: degree" << endl;
+    cout << "       histograms by node type, edge counts by attribute value, the times" << endl;
+    cout << "       between edges, and the busiest nodes.  Without -q, it stops there." << endl;
+    cout << endl;
+    cout << "Node order arguments:" << endl;
+    cout << "  -reorder [first-activity|rcm|degree]" << endl;
+    cout << "       Renumbers the data graph's nodes after loading it, so the ones used" << endl;
+    cout << "       together are close together in memory: in the order of their first" << endl;
+    cout << "       edge, breadth first from low degree nodes (reverse Cuthill-McKee)," << endl;
+    cout << "       or busiest first.  Names and results don't change, and snapshots" << endl;
+    cout << "       saved afterwards keep the new order." << endl;
+    cout << "  -reorder-benchmark" << endl;
+    cout << "       Times the search for each query (-q) and delta with each node order," << endl;
+    cout << "       along with the CPU cache misses, if they can be counted." << endl;
+    cout << endl;
+    cout << "Streaming arguments:" << endl;
+    cout << "  -stream [filename]" << endl;
+    cout << "       Searches in real time, using the settings in the given JSON config" << endl;
+    cout << "       file.  The data graph (-g) is a GDF file or folder that keeps getting" << endl;
+    cout << "       new data, and the query counts are saved to the GraphInfo JSON file" << endl;
+    cout << "       (-o, or GraphInfo.json by default) after each block of data." << endl;
+    cout << endl;
     cout << "Other arguments:" << endl;
     cout << "  -delta [t]" << endl;
     cout << "       Specifies max duration (in seconds) between matched temporal edges." << endl;
     cout << "       (Default is 24 hours)." << endl;
+    cout << "  -explain" << endl;
+    cout << "       Prints the query plan used for each search, with the estimated and" << endl;
+    cout << "       actual number of partial matches for each query edge." << endl;
     cout << "NOTE:" << endl;
     cout << "   As a shortcut, instead of entering duration times in seconds, you can use" << endl;
     cout << "   the following abbreviations for different time scales:" << endl;
     cout << "      w = week, d = day, h = hour, m = minute" << endl;
     cout << "   So a delta duration of one hour can be represented as 1h instead of 3600." << endl;
+    cout << "   Arguments can also start with two dashes (e.g., --save-snapshot)." << endl;
     cout << endl;
 }
 
@@ -19,8 +19,20 @@ public:
     const std::string &outFname() const { return _outFname; }
     //const std::vector<std::string> &outFnames() const { return _outFnames; }
     const std::vector<time_t> &deltaValues() const { return _deltaValues; }    
+    /** If not empty, the data graph should just be saved as a snapshot with this name */
+    const std::string &snapshotFname() const { return _snapshotFname; }
+    /** If not empty, the search should be streamed using the settings in this JSON file */
+    const std::string &configFname() const { return _configFname; }
+    /** If not empty, the data graph's statistics should be saved to this JSON file */
+    const std::string &statsFname() const { return _statsFname; }
     bool success() const { return _success; }
     bool unordered() const { return _unordered; }
+    /** If true, prints the query plan of each search */
+    bool explain() const { return _explain; }
+    /** If not empty, the data graph's nodes should be renumbered in this order (see NodeOrder) */
+    const std::string &reorder() const { return _reorder; }
+    /** If true, times the search with each node order, instead of saving the results */
+    bool reorderBenchmark() const { return _reorderBenchmark; }
     void dispHelp() const;
      /** Parses the time in the string as seconds. Makes putting in long durations
      * less painful on the command line.
@@ -40,11 +52,11 @@ public:
      */
     std::string createOutFname(const std::string &gFname, const std::string &hFname, time_t delta);
 private:
-    std::string _graphFname, _outFname; // _queryFname
+    std::string _graphFname, _outFname, _snapshotFname, _configFname, _statsFname, _reorder; // _queryFname
     std::vector<std::string> _queryFnames; // _outFnames;
     std::vector<time_t> _deltaValues;
     time_t _delta;
-    bool _success, _unordered;
+    bool _success, _unordered, _explain, _reorderBenchmark;
 };
 
 #endif
@@ -0,0 +1,277 @@
+#include "ColumnScan.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define COLUMN_SCAN_X86
+#endif
+
+namespace
+{
+    typedef void (*IntRangeFunc)(const int*, int, int, int, uint64_t*);
+    typedef void (*FloatRangeFunc)(const float*, int, float, float, uint64_t*);
+    typedef void (*FloatEqualsFunc)(const float*, int, float, uint64_t*);
+    typedef uint32_t (*EdgeNodesFunc)(const int*, const int*, int, bool, int, int, const int*);
+
+    /** Set of kernels for one instruction set */
+    struct Kernels
+    {
+        const char *name;
+        IntRangeFunc intRange;
+        FloatRangeFunc floatRange;
+        FloatEqualsFunc floatEquals;
+        EdgeNodesFunc edgeNodes;
+    };
+
+    // Scalar fallback
+    //------------------------
+
+    void intRangeScalar(const int *values, int n, int lo, int hi, uint64_t *bits)
+    {
+        for(int i=0; i<n; i++)
+        {
+            int x = values[i];
+            if(x < lo || x > hi)
+                bits[i >> 6] &= ~(1ULL << (i & 63));
+        }
+    }
+
+    void floatRangeScalar(const float *values, int n, float lo, float hi, uint64_t *bits)
+    {
+        for(int i=0; i<n; i++)
+        {
+            float x = values[i];
+            if(x < lo || x > hi)
+                bits[i >> 6] &= ~(1ULL << (i & 63));
+        }
+    }
+
+    void floatEqualsScalar(const float *values, int n, float value, uint64_t *bits)
+    {
+        for(int i=0; i<n; i++)
+        {
+            if(values[i] != value)
+                bits[i >> 6] &= ~(1ULL << (i & 63));
+        }
+    }
+
+    uint32_t edgeNodesScalar(const int *nodes, const int *candidates, int count, bool isSelfLoop,
+                             int source, int dest, const int *nodeMap)
+    {
+        uint32_t mask = 0;
+        for(int k=0; k<count; k++)
+        {
+            int u = nodes[2*candidates[k]], v = nodes[2*candidates[k] + 1];
+            bool uMatch = source >= 0 ? u == source : nodeMap[u] < 0;
+            bool vMatch = dest >= 0 ? v == dest : nodeMap[v] < 0;
+            bool pass = ((u == v) == isSelfLoop) & uMatch & vMatch;
+            mask |= (uint32_t)pass << k;
+        }
+        return mask;
+    }
+
+#ifdef COLUMN_SCAN_X86
+
+    // SSE2 (4 values per compare)
+    //------------------------
+
+    void intRangeSSE2(const int *values, int n, int lo, int hi, uint64_t *bits)
+    {
+        __m128i vlo = _mm_set1_epi32(lo), vhi = _mm_set1_epi32(hi);
+        int full = n & ~63;
+        for(int i=0; i<full; i+=64)
+        {
+            uint64_t fail = 0;
+            for(int j=0; j<64; j+=4)
+            {
+                __m128i x = _mm_loadu_si128((const __m128i*)(values+i+j));
+                __m128i bad = _mm_or_si128(_mm_cmpgt_epi32(vlo, x), _mm_cmpgt_epi32(x, vhi));
+                fail |= (uint64_t)_mm_movemask_ps(_mm_castsi128_ps(bad)) << j;
+            }
+            bits[i >> 6] &= ~fail;
+        }
+        intRangeScalar(values+full, n-full, lo, hi, bits+(full >> 6));
+    }
+
+    void floatRangeSSE2(const float *values, int n, float lo, float hi, uint64_t *bits)
+    {
+        __m128 vlo = _mm_set1_ps(lo), vhi = _mm_set1_ps(hi);
+        int full = n & ~63;
+        for(int i=0; i<full; i+=64)
+        {
+            uint64_t fail = 0;
+            for(int j=0; j<64; j+=4)
+            {
+                __m128 x = _mm_loadu_ps(values+i+j);
+                __m128 bad = _mm_or_ps(_mm_cmplt_ps(x, vlo), _mm_cmpgt_ps(x, vhi));
+                fail |= (uint64_t)_mm_movemask_ps(bad) << j;
+            }
+            bits[i >> 6] &= ~fail;
+        }
+        floatRangeScalar(values+full, n-full, lo, hi, bits+(full >> 6));
+    }
+
+    void floatEqualsSSE2(const float *values, int n, float value, uint64_t *bits)
+    {
+        __m128 v = _mm_set1_ps(value);
+        int full = n & ~63;
+        for(int i=0; i<full; i+=64)
+        {
+            uint64_t fail = 0;
+            for(int j=0; j<64; j+=4)
+            {
+                __m128 x = _mm_loadu_ps(values+i+j);
+                fail |= (uint64_t)_mm_movemask_ps(_mm_cmpneq_ps(x, v)) << j;
+            }
+            bits[i >> 6] &= ~fail;
+        }
+        floatEqualsScalar(values+full, n-full, value, bits+(full >> 6));
+    }
+
+    // AVX2 (8 values per compare)
+    //------------------------
+
+    __attribute__((target("avx2")))
+    void intRangeAVX2(const int *values, int n, int lo, int hi, uint64_t *bits)
+    {
+        __m256i vlo = _mm256_set1_epi32(lo), vhi = _mm256_set1_epi32(hi);
+        int full = n & ~63;
+        for(int i=0; i<full; i+=64)
+        {
+            uint64_t fail = 0;
+            for(int j=0; j<64; j+=8)
+            {
+                __m256i x = _mm256_loadu_si256((const __m256i*)(values+i+j));
+                __m256i bad = _mm256_or_si256(_mm256_cmpgt_epi32(vlo, x), _mm256_cmpgt_epi32(x, vhi));
+                fail |= (uint64_t)_mm256_movemask_ps(_mm256_castsi256_ps(bad)) << j;
+            }
+            bits[i >> 6] &= ~fail;
+        }
+        intRangeScalar(values+full, n-full, lo, hi, bits+(full >> 6));
+    }
+
+    __attribute__((target("avx2")))
+    void floatRangeAVX2(const float *values, int n, float lo, float hi, uint64_t *bits)
+    {
+        __m256 vlo = _mm256_set1_ps(lo), vhi = _mm256_set1_ps(hi);
+        int full = n & ~63;
+        for(int i=0; i<full; i+=64)
+        {
+            uint64_t fail = 0;
+            for(int j=0; j<64; j+=8)
+            {
+                __m256 x = _mm256_loadu_ps(values+i+j);
+                __m256 bad = _mm256_or_ps(_mm256_cmp_ps(x, vlo, _CMP_LT_OQ), _mm256_cmp_ps(x, vhi, _CMP_GT_OQ));
+                fail |= (uint64_t)_mm256_movemask_ps(bad) << j;
+            }
+            bits[i >> 6] &= ~fail;
+        }
+        floatRangeScalar(values+full, n-full, lo, hi, bits+(full >> 6));
+    }
+
+    __attribute__((target("avx2")))
+    void floatEqualsAVX2(const float *values, int n, float value, uint64_t *bits)
+    {
+        __m256 v = _mm256_set1_ps(value);
+        int full = n & ~63;
+        for(int i=0; i<full; i+=64)
+        {
+            uint64_t fail = 0;
+            for(int j=0; j<64; j+=8)
+            {
+                __m256 x = _mm256_loadu_ps(values+i+j);
+                fail |= (uint64_t)_mm256_movemask_ps(_mm256_cmp_ps(x, v, _CMP_NEQ_UQ)) << j;
+            }
+            bits[i >> 6] &= ~fail;
+        }
+        floatEqualsScalar(values+full, n-full, value, bits+(full >> 6));
+    }
+
+    __attribute__((target("avx2")))
+    uint32_t edgeNodesAVX2(const int *nodes, const int *candidates, int count, bool isSelfLoop,
+                           int source, int dest, const int *nodeMap)
+    {
+        const __m256i lanes = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        const __m256i zero = _mm256_setzero_si256();
+        __m256i loopFlip = _mm256_set1_epi32(isSelfLoop ? 0 : -1);
+        uint32_t mask = 0;
+        for(int k=0; k<count; k+=8)
+        {
+            // (the lanes past the last candidate aren't loaded)
+            __m256i live = _mm256_cmpgt_epi32(_mm256_set1_epi32(count - k), lanes);
+            __m256i edge = _mm256_maskload_epi32(candidates + k, live);
+            __m256i u = _mm256_mask_i32gather_epi32(zero, nodes, edge, live, 8);
+            __m256i v = _mm256_mask_i32gather_epi32(zero, nodes + 1, edge, live, 8);
+            __m256i pass = _mm256_and_si256(live, _mm256_xor_si256(_mm256_cmpeq_epi32(u, v), loopFlip));
+            if(source >= 0)
+                pass = _mm256_and_si256(pass, _mm256_cmpeq_epi32(u, _mm256_set1_epi32(source)));
+            else
+                pass = _mm256_and_si256(pass, _mm256_cmpgt_epi32(zero, _mm256_mask_i32gather_epi32(zero, nodeMap, u, pass, 4)));
+            if(dest >= 0)
+                pass = _mm256_and_si256(pass, _mm256_cmpeq_epi32(v, _mm256_set1_epi32(dest)));
+            else
+                pass = _mm256_and_si256(pass, _mm256_cmpgt_epi32(zero, _mm256_mask_i32gather_epi32(zero, nodeMap, v, pass, 4)));
+            mask |= (uint32_t)_mm256_movemask_ps(_mm256_castsi256_ps(pass)) << k;
+        }
+        return mask;
+    }
+
+#endif
+
+    const Kernels SCALAR = { "scalar", intRangeScalar, floatRangeScalar, floatEqualsScalar, edgeNodesScalar };
+
+    /** Picks the best kernels supported by this CPU */
+    const Kernels &detectKernels()
+    {
+#ifdef COLUMN_SCAN_X86
+        static const Kernels AVX2 = { "AVX2", intRangeAVX2, floatRangeAVX2, floatEqualsAVX2, edgeNodesAVX2 };
+        static const Kernels SSE2 = { "SSE2", intRangeSSE2, floatRangeSSE2, floatEqualsSSE2, edgeNodesScalar };
+        __builtin_cpu_init();
+        if(__builtin_cpu_supports("avx2"))
+            return AVX2;
+        if(__builtin_cpu_supports("sse2"))
+            return SSE2;
+#endif
+        return SCALAR;
+    }
+
+    bool forcedScalar = false;
+
+    const Kernels &kernels()
+    {
+        static const Kernels &detected = detectKernels();
+        if(forcedScalar)
+            return SCALAR;
+        return detected;
+    }
+}
+
+const char *ColumnScan::implementation()
+{
+    return kernels().name;
+}
+
+void ColumnScan::forceScalar(bool scalar)
+{
+    forcedScalar = scalar;
+}
+
+void ColumnScan::intRange(const int *values, int n, int lo, int hi, uint64_t *bits)
+{
+    kernels().intRange(values, n, lo, hi, bits);
+}
+
+void ColumnScan::floatRange(const float *values, int n, float lo, float hi, uint64_t *bits)
+{
+    kernels().floatRange(values, n, lo, hi, bits);
+}
+
+void ColumnScan::floatEquals(const float *values, int n, float value, uint64_t *bits)
+{
+    kernels().floatEquals(values, n, value, bits);
+}
+
+uint32_t ColumnScan::edgeNodes(const int *nodes, const int *candidates, int count, bool isSelfLoop,
+                               int source, int dest, const int *nodeMap)
+{
+    return kernels().edgeNodes(nodes, candidates, count, isSelfLoop, source, dest, nodeMap);
+}
@@ -0,0 +1,48 @@
+#ifndef COLUMN_SCAN_H
+#define COLUMN_SCAN_H
+
+#include <stdint.h>
+
+/**
+ * Vectorized predicates over attribute columns.  Each function tests n values
+ * of a column and clears the bit of every row that fails, so several
+ * predicates can be ANDed together into one survivor bitmap (one bit per row,
+ * 64 rows per word, row 0 in the lowest bit of bits[0]).  The search also
+ * uses it to test blocks of candidate edges against a partial match.
+ *
+ * The implementation (AVX2, SSE2 or plain scalar code) is picked at runtime
+ * based on what the CPU supports.
+ */
+class ColumnScan
+{
+public:
+    /** Name of the implementation being used ("AVX2", "SSE2" or "scalar") */
+    static const char *implementation();
+    /** Forces the scalar fallback on or off (useful for testing). */
+    static void forceScalar(bool scalar);
+    /** Clears the bits of rows where the value is not within [lo, hi]. */
+    static void intRange(const int *values, int n, int lo, int hi, uint64_t *bits);
+    /** Clears the bits of rows where the value is < lo or > hi.
+     * (NaN values are never less or greater than anything, so they pass.) */
+    static void floatRange(const float *values, int n, float lo, float hi, uint64_t *bits);
+    /** Clears the bits of rows where the value doesn't equal the given value. */
+    static void floatEquals(const float *values, int n, float value, uint64_t *bits);
+    /**
+     * Tests up to 32 edges (picked from the edge list by index) for the parts
+     * of a query edge match that only depend on their nodes: being a self-loop
+     * if the query edge is, and having the given nodes (or nodes that aren't
+     * mapped yet, if no node is given).  (AVX2 gathers 8 edges at a time; SSE2
+     * has no gathers, so it uses the scalar code.)
+     * @param nodes  Source and dest of every edge, one after the other.
+     * @param candidates  Indexes of the edges to test.
+     * @param count  Number of candidates.
+     * @param isSelfLoop  Whether the edges have to be self-loops, or not.
+     * @param source, dest  Node each edge has to have, or -1 for any unmapped node.
+     * @param nodeMap  Query node each node is mapped to (-1 if it isn't).
+     * @return  Mask with bit k set if candidate k passed.
+     */
+    static uint32_t edgeNodes(const int *nodes, const int *candidates, int count, bool isSelfLoop,
+                              int source, int dest, const int *nodeMap);
+};
+
+#endif
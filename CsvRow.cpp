@@ -0,0 +1,140 @@
+#include "CsvRow.h"
+#include <string.h>
+#include <algorithm>
+#include <iostream>
+
+using namespace std;
+
+CsvRow::CsvRow(char delim) : _delim(delim)
+{
+}
+
+const char *CsvRow::parse(const char *begin, const char *end)
+{
+    const char *eol = (const char*)memchr(begin, '\n', end - begin);
+    if(eol == 0)
+        eol = end;
+
+    // Every character in the line makes at most one in the buffer
+    // (delimiters become NULs), plus the final NUL
+    size_t len = eol - begin;
+    if(_buf.size() < len + 1)
+        _buf.resize(len + 1);
+    this->split(begin, eol, _buf.data(), eol < end);
+    return eol < end ? eol + 1 : end;
+}
+
+char *CsvRow::parseInPlace(char *begin, char *end)
+{
+    char *eol = (char*)memchr(begin, '\n', end - begin);
+    if(eol == 0)
+        eol = end;
+    this->split(begin, eol, begin, eol < end);
+    return eol < end ? eol + 1 : end;
+}
+
+void CsvRow::split(const char *begin, const char *eol, char *dst, bool hasLineBreak)
+{
+    _vars.clear();
+    const char *last = eol;
+    // For DOS vs Unix return lines
+    if(last > begin && last[-1] == '\r')
+        last--;
+    size_t len = last - begin;
+
+    if(memchr(begin, '"', len) == 0 && memchr(begin, '\r', len) == 0)
+    {
+        // No quotes, so every field simply ends at the next delimiter
+        const char *p = begin;
+        while(true)
+        {
+            while(p < last && *p == ' ')
+                p++;
+            const char *q = (const char*)memchr(p, _delim, last - p);
+            if(q == 0)
+                q = last;
+            // When parsing in place, the field only moves if it had leading spaces
+            char *field = dst + (p - begin);
+            if(field != p)
+                memmove(field, p, q - p);
+            field[q - p] = '\0';
+            _vars.push_back(field);
+            if(q == last)
+                return;
+            p = q + 1;
+        }
+    }
+
+    // Quoted fields have to be copied one character at a time
+    char *out = dst;
+    _vars.push_back(out);
+    bool inQuote = false, inText = false;
+    for(const char *p = begin; p < eol; p++)
+    {
+        char c = *p;
+        if(c == '"')
+        {
+            inQuote = !inQuote;
+            inText = inQuote;
+        }
+        else if(c == '\r')
+            continue;
+        else if(c == _delim && !inQuote)
+        {
+            inText = false;
+            *out++ = '\0';
+            _vars.push_back(out);
+        }
+        else if(inText || c != ' ')
+        {
+            inText = true;
+            *out++ = c;
+        }
+    }
+    *out = '\0';
+
+    if(inQuote && hasLineBreak)
+        throw "Line break found inside quotation marks.";
+}
+
+string CsvRow::str() const
+{
+    string s;
+    for(int i=0; i<_vars.size(); i++)
+    {
+        if(i > 0)
+            s += _delim;
+        s += _vars[i];
+    }
+    return s;
+}
+
+void CsvRow::disp() const
+{
+    cout << this->str() << endl;
+}
+
+vector<const char*> CsvRow::splitLines(const char *begin, const char *end, int numChunks)
+{
+    vector<const char*> bounds;
+    bounds.push_back(begin);
+    size_t chunkSize = (end - begin) / max(1, numChunks) + 1;
+    const char *p = begin;
+    while(p < end)
+    {
+        const char *next = p + chunkSize;
+        if(next >= end)
+            next = end;
+        else
+        {
+            // Move forward to the start of the next line
+            next = (const char*)memchr(next, '\n', end - next);
+            next = (next == 0) ? end : next + 1;
+        }
+        bounds.push_back(next);
+        p = next;
+    }
+    if(bounds.size() == 1)
+        bounds.push_back(end);
+    return bounds;
+}
@@ -0,0 +1,59 @@
+#ifndef CSV_ROW_H
+#define CSV_ROW_H
+
+#include <string>
+#include <vector>
+
+/**
+ * Parses one line of CSV text at a time out of a block of memory (such as a
+ * mapped file), using the same rules as FastReader: fields can be quoted
+ * (the quotes are removed, and delimiters inside them are kept), spaces at
+ * the start of an unquoted field are skipped, and DOS line endings are
+ * handled.  There are no limits on the number or size of the fields.
+ *
+ * Lines without quotes (the usual case) are split with memchr(), so each
+ * field is found without looking at its characters one at a time.
+ */
+class CsvRow
+{
+public:
+    CsvRow(char delim = ',');
+    /**
+     * Parses the line starting at begin, and returns where the next line starts
+     * (or end, if it was the last line).  Throws an exception if a line break
+     * is found inside quotation marks.
+     */
+    const char *parse(const char *begin, const char *end);
+    /**
+     * Same as parse(), except the fields are stored in the line itself (which
+     * gets overwritten), so nothing is copied.  There must be room for one
+     * more character at end, in case the last line has no line break.
+     */
+    char *parseInPlace(char *begin, char *end);
+    /** NUL terminated fields of the last line parsed */
+    char **vars() { return _vars.data(); }
+    /** Number of fields in the last line parsed (a blank line has 1 empty field) */
+    int size() const { return _vars.size(); }
+    /** The row's fields, joined back together with the delimiter */
+    std::string str() const;
+    /** Prints the row */
+    void disp() const;
+
+    /**
+     * Splits the text into (at most) numChunks pieces of about equal size,
+     * where every piece ends at a line break.  Returns the boundaries of the
+     * pieces (i.e., piece i is from [i] to [i+1]).
+     */
+    static std::vector<const char*> splitLines(const char *begin, const char *end, int numChunks);
+
+private:
+    /** Splits the line [begin, eol) into NUL terminated fields written to dst
+     * (which can be begin itself, since the fields never get longer). */
+    void split(const char *begin, const char *eol, char *dst, bool hasLineBreak);
+
+    char _delim;
+    std::vector<char> _buf;
+    std::vector<char*> _vars;
+};
+
+#endif
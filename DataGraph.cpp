@@ -1,18 +1,19 @@
 #include "DataGraph.h"
+#include <algorithm>
 #include <iostream>
 
 using namespace std;
 
 void DataGraph::addNode(int v)
 {
+    this->checkNotFrozen();
     string name = to_string(v);
     if(_nodeNames.size() <= v)
     {
 	_nodeNames.resize(v+1);
-	_nodeAttributes.resize(v+1);
+	_nodeColumns.resize(v+1);
     }
-    _nodeNames[v] = to_string(v);
-    _nodeNameMap[name] = v;
+    _nodeNames.set(v, name);
     Graph::addNode(v);
 }
 
@@ -30,12 +31,14 @@ void DataGraph::addNode(const std::string &name, const Attributes &a)
         cerr << _nodeAttributesDef.numStringValues() << " string values" << endl;
 	throw "Node attributes don't match the attributes set in the definition.";
     }
+    this->checkNotFrozen();
 
-    int u = _nodeNameMap.size();
-    _nodeNames.push_back(name);
-    _nodeNameMap[name] = u;
-    Graph::addNode(u);
-    _nodeAttributes.push_back(a);
+    // A node we've seen before (e.g., in an earlier file) keeps its index
+    int u = _nodeNames.find(name);
+    if(u < 0)
+        u = this->addNodeName(name);
+    _nodeColumns.resize(u+1);
+    _nodeColumns.set(u, a);
 }
 
 void DataGraph::addEdge(int u, int v)
@@ -47,9 +50,10 @@ void DataGraph::addEdge(int u, int v)
 void DataGraph::addEdge(int u, int v, time_t dateTime)
 {
     Graph::addEdge(u,v,dateTime);
-    Attributes a;
-    _edgeAttributes.push_back(a);
-    _timeEdgeAttributesMap[dateTime].push_back(a);
+    _insertedEdgeColumns.addDefault();
+    // Edges added in order don't need to be sorted later
+    if(_edgesReady)
+        _edgeColumns.addDefault();
 }
 
 void DataGraph::addEdge(const std::string &source, const std::string &dest, time_t dateTime, const Attributes &a)
@@ -67,46 +71,121 @@ void DataGraph::addEdge(const std::string &source, const std::string &dest, time
 	throw "Edge attributes don't match the attributes set in the definition.";
     }
 
-    int u = _nodeNameMap[source];
-    int v = _nodeNameMap[dest];
+    int u = this->findNode(source);
+    int v = this->findNode(dest);
     Graph::addEdge(u,v,dateTime);
-    _edgeAttributes.push_back(a);
-    _timeEdgeAttributesMap[dateTime].push_back(a);
+    _insertedEdgeColumns.add(a);
+    if(_edgesReady)
+        _edgeColumns.add(a);
+}
+
+void DataGraph::appendEdges(const vector<int> &sources, const vector<int> &dests, 
+                            const vector<time_t> &times, const AttributeColumns &columns)
+{
+    int m = times.size();
+    if(sources.size() != m || dests.size() != m || columns.size() != m)
+        throw "Can't append edges. Number of sources, destinations, times and attributes don't match.";
+    for(int i=0; i<m; i++)
+        Graph::addEdge(sources[i], dests[i], times[i]);
+    _insertedEdgeColumns.append(columns);
+    // If they were all in order, they're all at the end of the chronological list too
+    if(_edgesReady)
+        _edgeColumns.append(columns);
 }
 
 void DataGraph::copyEdge(int edgeIndex, const Graph &g)
 {
+    this->checkNotFrozen();
     const DataGraph &dg = (const DataGraph&)g;
-    int n = g.nodes().size();
-    // Make sure we actually have all the node values, etc, first
-    if(n > _nodeNames.size())
+    // Start with all of the other graph's nodes, so they keep their indexes
+    // (unless nodes get removed, in which case only the ones used are added)
+    if(_nodeNames.size() == 0 && !_removeIdleNodes)
     {
 	_nodeNames = dg._nodeNames;
-	_nodeNameMap = dg._nodeNameMap;
-	_nodeAttributes = dg._nodeAttributes;
+	_nodeColumns = dg._nodeColumns;
     }
 
     const Edge &edge = dg.edges()[edgeIndex];
-    const Attributes &a = dg.edgeAttributes()[edgeIndex];
 
-    /*int e = this->numEdges();
-    Graph::copyEdge(edgeIndex, dg);
-    _edgeAttributes.push_back(a);
-    _timeEdgeAttributesMap[edge.time()].push_back(a);*/
-    
-    const string &node1 = _nodeNames[edge.source()];
-    const string &node2 = _nodeNames[edge.dest()];
-    this->addEdge(node1, node2, edge.time(), a);
+    // Copy the attributes straight from the columns, without creating
+    // an Attributes object for each edge.
+    int u = this->copyNode(edge.source(), dg);
+    int v = this->copyNode(edge.dest(), dg);
+    Graph::addEdge(u,v,edge.time());
+    _insertedEdgeColumns.copyRow(dg.edgeColumns(), edgeIndex);
+    if(_edgesReady)
+        _edgeColumns.copyRow(dg.edgeColumns(), edgeIndex);
+}
+
+int DataGraph::copyNode(int v, const DataGraph &g)
+{
+    // (the nodes are matched by name, since either graph may have removed nodes)
+    string name = g._nodeNames.get(v);
+    int u = _nodeNames.find(name);
+    if(u >= 0)
+        return u;
+    u = this->addNodeName(name);
+    _nodeColumns.resize(u+1);
+    _nodeColumns.set(u, g._nodeColumns.get(v));
+    return u;
+}
+
+int DataGraph::addNodeName(const string &name)
+{
+    if(_freeNodes.empty())
+    {
+        int u = _nodeNames.add(name);
+        Graph::addNode(u);
+        return u;
+    }
+    int u = _freeNodes.back();
+    _freeNodes.pop_back();
+    _nodeNames.set(u, name);
+    return u;
+}
+
+void DataGraph::renumberNodes(const vector<int> &order)
+{
+    Graph::renumberNodes(order);
+
+    NodeNames names;
+    for(int v : order)
+        names.add(v < _nodeNames.size() ? _nodeNames.get(v) : "");
+    _nodeNames = names;
+
+    int n = order.size();
+    if(_nodeColumns.size() < n)
+        _nodeColumns.resize(n);
+    AttributeColumns columns = _nodeColumns;
+    _nodeColumns.gather(columns, order);
+
+    vector<int> newIds(n);
+    for(int i=0; i<n; i++)
+        newIds[order[i]] = i;
+    for(int &v : _freeNodes)
+        v = newIds[v];
 }
 
 void DataGraph::setNodeAttributesDef(const AttributesDef &def)
 {
+    this->checkNotFrozen();
     _nodeAttributesDef = def;
+    int n = _nodeColumns.size();
+    _nodeColumns.setDef(def);
+    _nodeColumns.resize(n);
 }
 
 void DataGraph::setEdgeAttributesDef(const AttributesDef &def)
 {
+    this->checkNotFrozen();
     _edgeAttributesDef = def;
+    int m = _insertedEdgeColumns.size();
+    _insertedEdgeColumns.setDef(def);
+    _insertedEdgeColumns.resize(m);
+    // Existing edges just get default values, so their order doesn't matter
+    m = _edgeColumns.size();
+    _edgeColumns.setDef(def);
+    _edgeColumns.resize(m);
 }
 
 const AttributesDef &DataGraph::nodeAttributesDef() const { return _nodeAttributesDef; }
@@ -116,8 +195,8 @@ const AttributesDef &DataGraph::edgeAttributesDef() const { return _edgeAttribut
 DataGraph DataGraph::createSubGraph(const std::vector<GraphMatch> &matches) const
 {
     DataGraph g;
-    g._nodeAttributesDef = this->_nodeAttributesDef;
-    g._edgeAttributesDef = this->_edgeAttributesDef;
+    g.setNodeAttributesDef(this->_nodeAttributesDef);
+    g.setEdgeAttributesDef(this->_edgeAttributesDef);
         
     // Determine which nodes we are using, and create edges between them
     unordered_map<int,int> edgeMap;
@@ -141,20 +220,20 @@ DataGraph DataGraph::createSubGraph(const std::vector<GraphMatch> &matches) cons
                 {
                     int u2 = nodeMap.size();
                     nodeMap[u] = u2;            
-                    g.addNode(this->getName(u),this->nodeAttributes()[u]);
-		    //g.setNodeAttributes(u2,this->nodeAttributes()[u]);
+                    g.addNode(this->getName(u),this->nodeAttributes(u));
+		    //g.setNodeAttributes(u2,this->nodeAttributes(u));
                 }
                 if(nodeMap.find(v) == nodeMap.end())
                 {
                     int v2 = nodeMap.size();
                     nodeMap[v] = v2;
-                    g.addNode(this->getName(v),this->nodeAttributes()[v]);
-		    //g.setNodeAttributes(v2,this->nodeAttributes()[v]);
+                    g.addNode(this->getName(v),this->nodeAttributes(v));
+		    //g.setNodeAttributes(v2,this->nodeAttributes(v));
                 }
-		const string &name1 = g.getName(nodeMap[u]);
-		const string &name2 = g.getName(nodeMap[v]);
-                g.addEdge(name1, name2, edge.time(), this->edgeAttributes()[e]);		
-		//g.setEdgeAttributes(e2,this->edgeAttributes()[e]);
+		string name1 = g.getName(nodeMap[u]);
+		string name2 = g.getName(nodeMap[v]);
+                g.addEdge(name1, name2, edge.time(), this->edgeAttributes(e));		
+		//g.setEdgeAttributes(e2,this->edgeAttributes(e));
             }
         }
     }
@@ -162,30 +241,49 @@ DataGraph DataGraph::createSubGraph(const std::vector<GraphMatch> &matches) cons
     return g;
 }
 
-const string &DataGraph::getName(int v) const
+string DataGraph::getName(int v) const
 {
-    return _nodeNames[v];
+    return _nodeNames.get(v);
 }
 
-const std::vector<Attributes> &DataGraph::nodeAttributes() const
+int DataGraph::findNode(const string &name) const
 {
-    return _nodeAttributes;
+    // Unknown names end up as node 0
+    int v = _nodeNames.find(name);
+    return v < 0 ? 0 : v;
 }
 
-const std::vector<Attributes> &DataGraph::edgeAttributes() const
+Attributes DataGraph::nodeAttributes(int v) const
 {
-    return _edgeAttributes;
+    return _nodeColumns.get(v);
+}
+
+Attributes DataGraph::edgeAttributes(int e) const
+{
+    return this->edgeColumns().get(e);
+}
+
+const AttributeColumns &DataGraph::nodeColumns() const
+{
+    return _nodeColumns;
+}
+
+const AttributeColumns &DataGraph::edgeColumns() const
+{
+    if(!_edgesReady)
+        this->updateOrderedEdges();
+    return _edgeColumns;
 }
 
 void DataGraph::dispNode(int u) const
 {
-    cout << u << "(" << _nodeNames[u];
-    const auto &values = _nodeAttributes[u].stringValues();
-    for(const string &val : values)
+    cout << u << "(" << _nodeNames.get(u);
+    Attributes a = this->nodeAttributes(u);
+    for(const string &val : a.stringValues())
 	cout << "," << val;
-    for(int val : _nodeAttributes[u].intValues())
+    for(int val : a.intValues())
         cout << "," << val;
-    for(double val : _nodeAttributes[u].floatValues())
+    for(double val : a.floatValues())
         cout << "," << val;
     cout << ")" << flush;
 }
@@ -197,12 +295,12 @@ void DataGraph::dispEdge(int e) const
     cout << " -> ";
     dispNode(edge.dest());
     cout << " " << edge.time();
-    const auto &values = _edgeAttributes[e].stringValues();
-    for(const string &val : values)
+    Attributes a = this->edgeAttributes(e);
+    for(const string &val : a.stringValues())
 	cout << "," << val;
-    for(int val : _edgeAttributes[e].intValues())
+    for(int val : a.intValues())
         cout << "," << val;
-    for(double val : _edgeAttributes[e].floatValues())
+    for(double val : a.floatValues())
         cout << "," << val;
     cout << flush;
 }
@@ -226,19 +324,40 @@ void DataGraph::updateOrderedEdges() const
     // Make sure base class is updated first
     Graph::updateOrderedEdges();
     
-    // Clear old edge attributes
-    _edgeAttributes.clear();
-    
-    // Build edge list in chronological order
-    for(auto &pair : _timeEdgeAttributesMap)
+    // Put the edge attribute columns in the same chronological order
+    _edgeColumns.gather(_insertedEdgeColumns, this->insertionOrder(), this->reorderStart());
+}
+
+
+
+void DataGraph::removeOldestEdges(int count)
+{
+    // Only the nodes of the old edges can be left without any
+    vector<int> idleNodes;
+    if(_removeIdleNodes)
     {
-        time_t dateTime = pair.first;
-        const vector<Attributes> &attributes = _timeEdgeAttributesMap.find(dateTime)->second;
-        for(const Attributes &a : attributes)
+        const EdgeNodes *edgeNodes = this->edges().nodes();
+        for(int e=0; e<count; e++)
         {
-            _edgeAttributes.push_back(a);
+            idleNodes.push_back(edgeNodes[e].source);
+            idleNodes.push_back(edgeNodes[e].dest);
         }
     }
-}
 
+    Graph::removeOldestEdges(count);
+    _edgeColumns.removeFirst(count);
+    // The remaining edges are renumbered in chronological order
+    _insertedEdgeColumns = _edgeColumns;
 
+    // Their indexes get reused for new nodes
+    sort(idleNodes.begin(), idleNodes.end());
+    idleNodes.erase(unique(idleNodes.begin(), idleNodes.end()), idleNodes.end());
+    for(int v : idleNodes)
+    {
+        if(this->nodes()[v].edges().empty())
+        {
+            _nodeNames.remove(v);
+            _freeNodes.push_back(v);
+        }
+    }
+}
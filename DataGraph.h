@@ -2,9 +2,11 @@
 #define DATA_GRAPH__H
 
 #include "Attributes.h"
+#include "AttributeColumns.h"
 #include "AttributesDef.h"
 #include "Graph.h"
 #include "GraphMatch.h"
+#include "NodeNames.h"
 #include <unordered_map>
 #include <vector>
 
@@ -15,23 +17,46 @@
 class DataGraph : public Graph
 {
 public:
+    DataGraph(int windowDuration=0) : Graph(windowDuration) {}
     virtual void addNode(int v) override;
+    /** Adds a node with the given name, or just updates the attributes if
+     * there's already a node with that name. */
     virtual void addNode(const std::string &name, const Attributes &a);
+    /**
+     * If set, removing old edges (see evictOldEdges()) also removes the nodes
+     * that don't have any edges left, and their indexes are reused for new
+     * nodes, so a graph whose nodes keep changing only keeps the ones in its
+     * window.  Off by default, since the nodes listed in a GDF file can be
+     * used by edges that come in later.
+     */
+    void setRemoveIdleNodes(bool remove) { _removeIdleNodes = remove; }
     virtual void addEdge(int u, int v) override;
     virtual void addEdge(int u, int v, time_t dateTime) override;
     virtual void addEdge(const std::string &source, const std::string &dest, time_t dateTime, const Attributes &a);
+    /** Adds several edges at once, with their attributes stored by column
+     * (e.g., as parsed by one thread). */
+    void appendEdges(const std::vector<int> &sources, const std::vector<int> &dests, 
+                     const std::vector<time_t> &times, const AttributeColumns &columns);
     virtual void copyEdge(int edgeIndex, const Graph &g) override;
+    /** Renumbers the nodes, moving their names and attributes with them */
+    virtual void renumberNodes(const std::vector<int> &order) override;
     virtual void setNodeAttributesDef(const AttributesDef &def);
     virtual void setEdgeAttributesDef(const AttributesDef &def);
     //virtual void setNodeAttributes(int v, const Attributes &attributes);
     //virtual void setEdgeAttributes(int e, const Attributes &attributes);
     virtual DataGraph createSubGraph(const std::vector<GraphMatch> &matches) const;
-    virtual const std::string &getName(int v) const;
+    virtual std::string getName(int v) const;
     virtual void dispNode(int u) const;
     virtual void dispEdge(int e) const;
     virtual void disp() const;
-    const std::vector<Attributes> &nodeAttributes() const;
-    const std::vector<Attributes> &edgeAttributes() const;
+    /** Attributes of the given node */
+    Attributes nodeAttributes(int v) const;
+    /** Attributes of the given edge */
+    Attributes edgeAttributes(int e) const;
+    /** Attributes of all nodes, stored by column */
+    const AttributeColumns &nodeColumns() const;
+    /** Attributes of all edges (in chronological order), stored by column */
+    const AttributeColumns &edgeColumns() const;
     const AttributesDef &nodeAttributesDef() const;
     const AttributesDef &edgeAttributesDef() const;
     //const std::vector<std::string> &nodeAttributeNames() const;
@@ -39,14 +64,33 @@ public:
 
 protected:
     virtual void updateOrderedEdges() const override;
+    virtual void removeOldestEdges(int count) override;
 
 private:
-    std::vector<std::string> _nodeNames;
-    std::unordered_map<std::string,int> _nodeNameMap;
+    // Snapshots are loaded directly into the graph's storage
+    friend class FileIO;
+
+    /** Index of the node with the given name (or 0 if there isn't one) */
+    int findNode(const std::string &name) const;
+    /** True if one of the nodes has the given name */
+    bool hasNode(const std::string &name) const { return _nodeNames.find(name) >= 0; }
+    /** Index of the node with the same name as node v in g, which is added
+     * (with its attributes) if there isn't one */
+    int copyNode(int v, const DataGraph &g);
+    /** Adds a node with the given name (reusing a removed node's index, if
+     * there is one), and returns its index.  Its attributes aren't set. */
+    int addNodeName(const std::string &name);
+
+    NodeNames _nodeNames;
     AttributesDef _nodeAttributesDef, _edgeAttributesDef;
-    std::vector<Attributes> _nodeAttributes;
-    std::map<time_t,std::vector<Attributes>> _timeEdgeAttributesMap;
-    mutable std::vector<Attributes> _edgeAttributes;
+    AttributeColumns _nodeColumns;
+    // Edge attributes in the order they were added
+    AttributeColumns _insertedEdgeColumns;
+    // Edge attributes in chronological order
+    mutable AttributeColumns _edgeColumns;
+    bool _removeIdleNodes = false;
+    // Indexes of removed nodes, to be reused
+    std::vector<int> _freeNodes;
 };
 
 #endif
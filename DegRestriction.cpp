@@ -1,4 +1,5 @@
 #include "DegRestriction.h"
+#include "TypeDictionary.h"
 #include <limits.h>
 
 using namespace std;
@@ -6,6 +7,7 @@ using namespace std;
 DegRestriction::DegRestriction(const std::string& edgeType, bool isOutDeg, bool isLessThan, int value)
 {
     _edgeType = edgeType;
+    _edgeTypeId = TypeDictionary::id(edgeType);
     _isOutDeg = isOutDeg;
     _isLessThan = isLessThan;
     _value = value;
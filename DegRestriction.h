@@ -20,11 +20,14 @@ class DegRestriction
 public:
     DegRestriction(const std::string &edgeType, bool isOutDeg, bool isLessThan, int value);
     const std::string &edgeType() const { return _edgeType; }
+    /** ID of the edge type in the TypeDictionary */
+    int edgeTypeId() const { return _edgeTypeId; }
     bool isOutDeg() const { return _isOutDeg; }
     bool isLessThan() const { return _isLessThan; }
     int value() const { return _value; }
 private:
     std::string _edgeType;
+    int _edgeTypeId;
     int _value;
     bool _isOutDeg, _isLessThan;
 };
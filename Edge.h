@@ -11,7 +11,8 @@
 #include <time.h>
 
 /**
- * Defines a basic directed edge in our graph.
+ * Defines a basic directed edge in our graph.  Graphs keep their edges in
+ * an EdgeList, which makes one of these whenever an edge is read.
  */
 class Edge
 {
@@ -0,0 +1,35 @@
+#include "EdgeCursor.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace
+{
+    bool isEarlier(const Edge &e, time_t t) { return e.time() < t; }
+    bool isLater(time_t t, const Edge &e) { return t < e.time(); }
+}
+
+int EdgeCursor::next(const Graph &g) const
+{
+    const EdgeList &edges = g.edges();
+    if(!_started)
+        return g.firstEdge();
+
+    // It's after the ones already processed at the last time processed
+    // (unless they've all been evicted since)
+    auto first = lower_bound(edges.begin() + g.firstEdge(), edges.end(), _time, isEarlier);
+    auto last = upper_bound(first, edges.end(), _time, isLater);
+    return min(first - edges.begin() + _numAtTime, last - edges.begin());
+}
+
+void EdgeCursor::advance(const Graph &g)
+{
+    const EdgeList &edges = g.edges();
+    if(edges.size() <= g.firstEdge())
+        return;
+
+    // More edges may still come in at the same time as the last one
+    _started = true;
+    _time = edges.back().time();
+    _numAtTime = edges.end() - lower_bound(edges.begin() + g.firstEdge(), edges.end(), _time, isEarlier);
+}
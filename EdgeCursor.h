@@ -0,0 +1,31 @@
+#ifndef EDGE_CURSOR_H
+#define EDGE_CURSOR_H
+
+#include "Graph.h"
+#include <time.h>
+
+/**
+ * Remembers how far along the edges of a growing graph we've processed.
+ * It goes by the time of the last edge processed (and how many edges had
+ * that time), instead of its index, so it still works after old edges are
+ * evicted.  Edges are expected to arrive (roughly) in chronological order:
+ * an edge that arrives after later edges have been processed is skipped.
+ */
+class EdgeCursor
+{
+public:
+    EdgeCursor() : _started(false), _time(0), _numAtTime(0) {}
+    /** Index of the first edge that hasn't been processed yet
+     * (or g.edges().size(), if there are none). */
+    int next(const Graph &g) const;
+    /** Marks all the edges in the graph as processed. */
+    void advance(const Graph &g);
+
+private:
+    bool _started;
+    // Latest edge time processed, and how many edges at that time were processed
+    time_t _time;
+    int _numAtTime;
+};
+
+#endif
@@ -0,0 +1,118 @@
+#include "EdgeList.h"
+#include <limits.h>
+#include <algorithm>
+
+using namespace std;
+
+namespace
+{
+    /** First index (from start on) in the sorted values with a value >= target */
+    template<typename T>
+    int gallop(const vector<T> &values, int start, T target)
+    {
+        int size = values.size();
+        int step = 1, end = start;
+        while(end < size && values[end] < target)
+        {
+            start = end + 1;
+            end += step;
+            step *= 2;
+        }
+        end = min(end, size);
+        return lower_bound(values.begin() + start, values.begin() + end, target) - values.begin();
+    }
+}
+
+void EdgeList::add(int source, int dest, time_t time)
+{
+    // The first edge's time is the base for the others
+    if(_nodes.empty())
+    {
+        this->clear();
+        _baseTime = time;
+    }
+    EdgeNodes nodes = { source, dest };
+    _nodes.push_back(nodes);
+    if(_isCompact && (time < _baseTime || (uint64_t)time - (uint64_t)_baseTime > UINT_MAX))
+        this->expandTimes();
+    if(_isCompact)
+        _timeOffsets.push_back((uint32_t)(time - _baseTime));
+    else
+        _times.push_back(time);
+}
+
+void EdgeList::assign(int m, const int32_t *sources, const int32_t *dests, const int64_t *times)
+{
+    this->clear();
+    this->reserve(m);
+    for(int e=0; e<m; e++)
+        this->add(sources[e], dests[e], times[e]);
+}
+
+void EdgeList::truncate(int m)
+{
+    _nodes.resize(m);
+    if(_isCompact)
+        _timeOffsets.resize(m);
+    else
+        _times.resize(m);
+}
+
+void EdgeList::removeFirst(int count)
+{
+    // (the base time stays the same, so the other offsets don't change)
+    _nodes.erase(_nodes.begin(), _nodes.begin() + count);
+    if(_isCompact)
+        _timeOffsets.erase(_timeOffsets.begin(), _timeOffsets.begin() + count);
+    else
+        _times.erase(_times.begin(), _times.begin() + count);
+}
+
+void EdgeList::renumberNodes(const vector<int> &newIds)
+{
+    for(EdgeNodes &nodes : _nodes)
+    {
+        nodes.source = newIds[nodes.source];
+        nodes.dest = newIds[nodes.dest];
+    }
+}
+
+void EdgeList::reserve(int m)
+{
+    _nodes.reserve(m);
+    if(_isCompact)
+        _timeOffsets.reserve(m);
+    else
+        _times.reserve(m);
+}
+
+void EdgeList::clear()
+{
+    _nodes.clear();
+    _timeOffsets.clear();
+    _times.clear();
+    _baseTime = 0;
+    _isCompact = true;
+}
+
+int EdgeList::firstAt(time_t t, int from) const
+{
+    if(!_isCompact)
+        return gallop(_times, from, t);
+
+    // Every edge is at or after the base time, and before 2^32 seconds after it
+    if(t <= _baseTime)
+        return min(from, this->size());
+    if((uint64_t)t - (uint64_t)_baseTime > UINT_MAX)
+        return this->size();
+    return gallop(_timeOffsets, from, (uint32_t)(t - _baseTime));
+}
+
+void EdgeList::expandTimes()
+{
+    _times.reserve(_timeOffsets.capacity());
+    for(uint32_t offset : _timeOffsets)
+        _times.push_back(_baseTime + offset);
+    vector<uint32_t>().swap(_timeOffsets);
+    _isCompact = false;
+}
@@ -0,0 +1,106 @@
+#ifndef EDGE_LIST_H
+#define EDGE_LIST_H
+
+#include "Edge.h"
+#include <stddef.h>
+#include <stdint.h>
+#include <time.h>
+#include <iterator>
+#include <vector>
+
+/** Source and destination node of an edge */
+struct EdgeNodes
+{
+    int source, dest;
+};
+
+/**
+ * Chronological list of a graph's edges, stored as an array of each edge's
+ * nodes and a separate array of their times.  An edge's index is its place
+ * in the list, so it isn't stored.  The times are kept as 32-bit offsets
+ * from the first edge's time, as long as every edge is within 2^32 seconds
+ * after it (otherwise they're kept as they are).  Edges are read as Edge
+ * objects, which are made on the fly.
+ */
+class EdgeList
+{
+public:
+    /** Iterates over the edges (as Edge objects), in order */
+    class const_iterator
+    {
+    public:
+        typedef std::random_access_iterator_tag iterator_category;
+        typedef Edge value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const Edge *pointer;
+        typedef Edge reference;
+
+        const_iterator() : _list(NULL), _e(0) {}
+        const_iterator(const EdgeList *list, int e) : _list(list), _e(e) {}
+        Edge operator*() const { return (*_list)[_e]; }
+        Edge operator[](ptrdiff_t i) const { return (*_list)[_e + i]; }
+        const_iterator &operator++() { _e++; return *this; }
+        const_iterator operator++(int) { const_iterator old = *this; _e++; return old; }
+        const_iterator &operator--() { _e--; return *this; }
+        const_iterator operator--(int) { const_iterator old = *this; _e--; return old; }
+        const_iterator &operator+=(ptrdiff_t i) { _e += i; return *this; }
+        const_iterator &operator-=(ptrdiff_t i) { _e -= i; return *this; }
+        const_iterator operator+(ptrdiff_t i) const { return const_iterator(_list, _e + i); }
+        const_iterator operator-(ptrdiff_t i) const { return const_iterator(_list, _e - i); }
+        ptrdiff_t operator-(const const_iterator &other) const { return _e - other._e; }
+        bool operator==(const const_iterator &other) const { return _e == other._e; }
+        bool operator!=(const const_iterator &other) const { return _e != other._e; }
+        bool operator<(const const_iterator &other) const { return _e < other._e; }
+        bool operator>(const const_iterator &other) const { return _e > other._e; }
+        bool operator<=(const const_iterator &other) const { return _e <= other._e; }
+        bool operator>=(const const_iterator &other) const { return _e >= other._e; }
+    private:
+        const EdgeList *_list;
+        int _e;
+    };
+
+    EdgeList() : _baseTime(0), _isCompact(true) {}
+    int size() const { return _nodes.size(); }
+    bool empty() const { return _nodes.empty(); }
+    /** Edge e (with e as its index) */
+    Edge operator[](int e) const { return Edge(e, _nodes[e].source, _nodes[e].dest, this->time(e)); }
+    Edge front() const { return (*this)[0]; }
+    Edge back() const { return (*this)[this->size()-1]; }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, this->size()); }
+    int source(int e) const { return _nodes[e].source; }
+    int dest(int e) const { return _nodes[e].dest; }
+    time_t time(int e) const { return _isCompact ? _baseTime + _timeOffsets[e] : _times[e]; }
+    /** Nodes of every edge, for loops that only need those */
+    const EdgeNodes *nodes() const { return _nodes.data(); }
+
+    /** Adds an edge to the end of the list (it has to be the latest one) */
+    void add(int source, int dest, time_t time);
+    /** Replaces the list with the given (chronological) edges */
+    void assign(int m, const int32_t *sources, const int32_t *dests, const int64_t *times);
+    /** Removes the edges from index m on */
+    void truncate(int m);
+    /** Removes the first count edges (the rest are moved down) */
+    void removeFirst(int count);
+    /** Changes each edge's nodes to their new indexes (node v becomes newIds[v]) */
+    void renumberNodes(const std::vector<int> &newIds);
+    void reserve(int m);
+    void clear();
+    /** First edge (from edge from on) at or after time t, or size() if there
+     * isn't one.  Steps twice as far each time, then does a binary search,
+     * so it's fast when the edge is close to from. */
+    int firstAt(time_t t, int from=0) const;
+
+private:
+    /** Stores the times as they are, once one doesn't fit in an offset */
+    void expandTimes();
+
+    std::vector<EdgeNodes> _nodes;
+    // Times of the edges, as offsets from _baseTime (if _isCompact), or as they are
+    time_t _baseTime;
+    bool _isCompact;
+    std::vector<uint32_t> _timeOffsets;
+    std::vector<time_t> _times;
+};
+
+#endif
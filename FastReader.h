@@ -1,25 +1,27 @@
-
 #ifndef FASTREADER_H
 #define FASTREADER_H
 
+#include "CsvRow.h"
 #include <fstream>
 #include <sstream>
 #include <string>
 #include <vector>
 
-/** Faster CSV reader, that has slightly less flexibility, due to 
- set limits on the number of vars and the size of the vars. */
+/** Fast CSV reader.  The file is read in large blocks, and each row's fields
+ are split in place inside the block (see CsvRow), so rows aren't copied and
+ there are no limits on the number of vars or the size of the vars. */
 class FastReader
 {
 public:
-    static constexpr int MAX_VARS = 100;
-    static constexpr int MAX_VAR_SIZE = 200;
-    
+    /** Size of each block read from the file (a longer line grows the buffer) */
+    static constexpr int BLOCK_SIZE = 1 << 20;
+
     FastReader(char delim = ',');
     FastReader(const std::string &fname, char delim = ',');
     ~FastReader();
     void open(const std::string &fname, char delim = ',');
     bool good() const;
+    /** Reads the next row.  The fields stay valid until the next call. */
     char ** next();
     char ** row() const;
     int rowSize() const;
@@ -27,11 +29,14 @@ public:
     void close();
     void dispRow() const;
 private:
-    char _delim;    
-    char **_row;
-    //std::vector<char> _buf;
-    //int _bufIndex;
-    int _rowSize;
+    /** Reads more of the file into the buffer, keeping the unparsed part */
+    void fill();
+
+    CsvRow _row;
+    std::vector<char> _buf;
+    // Unparsed part of the buffer
+    int _bufStart, _bufEnd;
+    bool _eof, _done;
     int _lineNum;
     std::ifstream _ifs;
 };
@@ -1,17 +1,23 @@
 #include "FileIO.h"
 #include "LabeledWeightedGraph.h"
+#include "CsvRow.h"
 #include "FastReader.h"
 #include "GraphMatch.h"
+#include "MappedFile.h"
+#include "Parallel.h"
 #include "SearchConfig.h"
+#include <ctype.h>
 #include <dirent.h>
 #include <sys/stat.h>
 #include <stdlib.h>
 #include <string.h>
 #include <time.h>
 
+#include <algorithm>
 #include <exception>
 #include <iostream>
 #include <fstream>
+#include <map>
 #include <regex>
 #include <sstream>
 #include <unordered_map>
@@ -24,6 +30,8 @@ const std::string FileIO::IS_STREAMING("isStreaming");
 const std::string FileIO::STREAM_DUR("duration");
 const std::string FileIO::STREAM_DELAY("delay");
 const std::string FileIO::STREAM_WIN("window");
+const std::string FileIO::CSV_COLUMNS("csvColumns");
+const std::string FileIO::CSV_HEADER("csvHeader");
 const std::string FileIO::DELTA("delta");
 const std::string FileIO::NUM_NODES("nodes");
 const std::string FileIO::NUM_LINKS("links");
@@ -35,6 +43,174 @@ const std::string FileIO::FIND_SUBGRAPHS_SECTION("find_subgraphs");
 const std::string FileIO::QUERY("query");
 const std::string FileIO::NODES("nodes");
 const std::string FileIO::LINKS("links");
+const char FileIO::SNAPSHOT_MAGIC[8] = {'D','Y','N','S','N','A','P','\0'};
+const uint32_t FileIO::SNAPSHOT_VERSION = 2;
+
+namespace
+{
+    /** Fixed size start of a snapshot file, followed by the sections and
+     * then a directory with the offset and size of each section. */
+    struct SnapshotHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t byteOrder;
+        int64_t numNodes;
+        int64_t numEdges;
+        int64_t numSections;
+        int64_t directoryOffset;
+    };
+
+    struct SnapshotSection
+    {
+        int64_t offset;
+        int64_t size;
+    };
+
+    const uint32_t BYTE_ORDER_MARK = 0x01020304;
+
+    /** Writes sections of a snapshot, 8-byte aligned */
+    class SnapshotWriter
+    {
+    public:
+        SnapshotWriter(std::ofstream &ofs) : _ofs(ofs) { _pos = sizeof(SnapshotHeader); }
+        void write(const void *data, size_t size)
+        {
+            static const char PADDING[8] = {0};
+            SnapshotSection section = { _pos, (int64_t)size };
+            _sections.push_back(section);
+            _ofs.write((const char*)data, size);
+            _pos += size;
+            int pad = (8 - _pos % 8) % 8;
+            _ofs.write(PADDING, pad);
+            _pos += pad;
+        }
+        template<class T> void write(const std::vector<T> &values) { write(values.data(), values.size() * sizeof(T)); }
+        void write(const std::string &str) { write(str.data(), str.size()); }
+        /** Writes the directory, and returns its offset */
+        int64_t finish()
+        {
+            int64_t offset = _pos;
+            _ofs.write((const char*)_sections.data(), _sections.size() * sizeof(SnapshotSection));
+            return offset;
+        }
+        int64_t numSections() const { return _sections.size(); }
+    private:
+        std::ofstream &_ofs;
+        int64_t _pos;
+        std::vector<SnapshotSection> _sections;
+    };
+
+    /** Reads the sections of a mapped snapshot in order */
+    class SnapshotReader
+    {
+    public:
+        SnapshotReader(const MappedFile &file, const SnapshotSection *sections, int64_t numSections) 
+            : _file(file), _sections(sections), _numSections(numSections), _next(0) {}
+        /** Returns the next section, making sure it has the expected number of values */
+        template<class T> const T *next(int64_t count)
+        {
+            const SnapshotSection &section = nextSection();
+            if(section.size != count * (int64_t)sizeof(T))
+                throw "Snapshot file is corrupt (unexpected section size).";
+            return (const T*)(_file.data() + section.offset);
+        }
+        std::string nextString()
+        {
+            const SnapshotSection &section = nextSection();
+            return std::string(_file.data() + section.offset, section.size);
+        }
+        /** Returns the next section, with any number of bytes */
+        const char *nextChars(int64_t &size)
+        {
+            const SnapshotSection &section = nextSection();
+            size = section.size;
+            return _file.data() + section.offset;
+        }
+    private:
+        const SnapshotSection &nextSection()
+        {
+            if(_next >= _numSections)
+                throw "Snapshot file is corrupt (missing sections).";
+            const SnapshotSection &section = _sections[_next++];
+            if(section.offset < 0 || section.size < 0 || section.offset + section.size > (int64_t)_file.size())
+                throw "Snapshot file is corrupt or truncated.";
+            return section;
+        }
+        const MappedFile &_file;
+        const SnapshotSection *_sections;
+        int64_t _numSections;
+        int64_t _next;
+    };
+
+    /** Smallest piece of a GDF edge section worth parsing on its own thread */
+    const size_t MIN_GDF_CHUNK = 1 << 20;
+
+    /** Edges parsed from one piece of a GDF file's edge section */
+    struct GdfEdgeChunk
+    {
+        const char *begin, *end;
+        int numLines;
+        // Node names (and edge types), NUL terminated
+        std::vector<char> text;
+        std::vector<size_t> sources, dests, types;
+        std::vector<time_t> times;
+        std::vector<int> u, v;
+        AttributeColumns columns;
+        // First problem found in this piece (if any)
+        const char *error;
+        int errorLine;
+        std::string errorRow;
+
+        size_t addText(const char *str)
+        {
+            size_t offset = text.size();
+            text.insert(text.end(), str, str + strlen(str) + 1);
+            return offset;
+        }
+        const char *getText(size_t offset) const { return text.data() + offset; }
+        void setError(const char *msg, const CsvRow &row)
+        {
+            error = msg;
+            errorLine = numLines;
+            errorRow = row.str();
+        }
+    };
+
+    /** Splits the edge section of a GDF file into pieces to parse on each thread */
+    std::vector<GdfEdgeChunk> splitEdgeSection(const char *begin, const char *end)
+    {
+        size_t numChunks = std::min((size_t)Parallel::numThreads(), std::max((size_t)1, (size_t)(end - begin) / MIN_GDF_CHUNK));
+        std::vector<const char*> bounds = CsvRow::splitLines(begin, end, numChunks);
+        std::vector<GdfEdgeChunk> chunks(bounds.size() - 1);
+        for(int i=0; i<chunks.size(); i++)
+        {
+            chunks[i].begin = bounds[i];
+            chunks[i].end = bounds[i+1];
+            chunks[i].numLines = 0;
+            chunks[i].error = 0;
+            chunks[i].errorLine = 0;
+        }
+        return chunks;
+    }
+
+    /** Reports the first problem found in the pieces (in file order), if any, and throws it.
+     * @param lineNum  Number of lines before the edge section. */
+    void checkEdgeChunks(const std::vector<GdfEdgeChunk> &chunks, int lineNum)
+    {
+        for(const GdfEdgeChunk &chunk : chunks)
+        {
+            if(chunk.error != 0)
+            {
+                cerr << "Problem on line #" << lineNum + chunk.errorLine << endl;
+                cerr << "Problematic line: " << chunk.errorRow << endl;
+                cerr << chunk.error << endl;
+                throw chunk.error;
+            }
+            lineNum += chunk.numLines;
+        }
+    }
+}
 
 
 Graph FileIO::loadEdges(const std::string& fname)
@@ -204,16 +380,21 @@ LabeledWeightedGraph FileIO::loadPajek(const string& fname)
 
 void FileIO::loadCertGDF(const std::string &fname, CertGraph &g)
 {
+    MappedFile file(fname);
+    const char *p = file.data(), *end = file.data() + file.size();
     int lineNum = 0;    
     bool nodeData = false, edgeData = false;    
-    FastReader csv(fname);
-    while(csv.good())
+
+    // Read the nodes, up to the start of the edge section
+    CsvRow row;
+    while(p < end && !edgeData)
     {
-        char **vars = csv.next();
-	int nc = csv.rowSize();
         lineNum++;
         try
         {
+            p = row.parse(p, end);
+            char **vars = row.vars();
+	    int nc = row.size();
             if(nc > 1)
             {
 		// Skip comments and empty lines
@@ -231,8 +412,7 @@ void FileIO::loadCertGDF(const std::string &fname, CertGraph &g)
                         continue;
                     }
                     // Add node to graph
-                    //cout << "Adding node" << endl;
-                    g.addTypedNode(vars[0],vars[1]); //,atof(vars[2].c_str()));
+                    g.addTypedNode(vars[0],vars[1]);
                     
                     // Get any deg restrictions, if they exist
                     if(nc == 3 && vars[2][0] != '\0')
@@ -240,21 +420,6 @@ void FileIO::loadCertGDF(const std::string &fname, CertGraph &g)
                         FileIO::addNodeRestrictions(vars[0], vars[2], g);
                     }
                 }
-                else if(edgeData)
-                {		    
-		    if(nc != 4)
-		    {
-			cerr << "ERROR: Row had " << nc << " columns, instead of 4." << endl;
-                        throw "Error reading GDF file. Edge data should have 4 columns.";                    
-		    }
-                    /*cout << "source: " << vars[0] << endl;
-                    cout << "dest: " << vars[1] << endl;
-                    cout << "type: " << vars[2] << endl;
-                    cout << "dateTime: " << vars[3] << endl;*/
-                    // Add edge to graph
-                    time_t dateTime = (long)(atof(vars[3]));
-                    g.addEdge(vars[0], vars[1], dateTime, vars[2]);
-                }
                 else
                 {
                     // Look to see if we reached the node data section (probably shouldn't happen)
@@ -274,7 +439,7 @@ void FileIO::loadCertGDF(const std::string &fname, CertGraph &g)
         {
             cerr << "Problem on line #" << lineNum << endl;
             cerr << "Problematic line: " << endl;
-	    csv.dispRow();
+	    row.disp();
 	    cerr << e.what() << endl;
             throw e.what();            
         }
@@ -282,7 +447,7 @@ void FileIO::loadCertGDF(const std::string &fname, CertGraph &g)
         {
             cerr << "Problem on line #" << lineNum << endl;
             cerr << "Problematic line: " << endl;
-	    csv.dispRow();
+	    row.disp();
 	    cerr << msg << endl;
             throw msg;            
         }
@@ -290,15 +455,87 @@ void FileIO::loadCertGDF(const std::string &fname, CertGraph &g)
         {
             cerr << "Problem on line #" << lineNum << endl;
             cerr << "Problematic line: " << endl;
-	    csv.dispRow();
+	    row.disp();
 	    cerr << "Unknown exception" << endl;
             throw "Unknown exception occurred when parsing CERT data.";
         }
     }
-    csv.close();
-    //cout << "Done reading data" << endl;
     if(edgeData == false)
         throw "Error reading GDF file. No edgedef> section found.";
+
+    // Parse pieces of the edge section on all cores
+    vector<GdfEdgeChunk> chunks = splitEdgeSection(p, end);
+    Parallel::forRange(chunks.size(), 1, 1, [&](int first, int last)
+    {
+        CsvRow row;
+        for(int i=first; i<last; i++)
+        {
+            GdfEdgeChunk &chunk = chunks[i];
+            const char *q = chunk.begin;
+            while(q < chunk.end)
+            {
+                chunk.numLines++;
+                try
+                {
+                    q = row.parse(q, chunk.end);
+                    char **vars = row.vars();
+                    int nc = row.size();
+                    // Skip comments and empty lines
+                    if(nc <= 1 || vars[0][0] == '\0' || vars[0][0] == '#')
+                        continue;
+                    if(nc != 4)
+                        throw "Error reading GDF file. Edge data should have 4 columns.";
+                    chunk.sources.push_back(chunk.addText(vars[0]));
+                    chunk.dests.push_back(chunk.addText(vars[1]));
+                    chunk.types.push_back(chunk.addText(vars[2]));
+                    chunk.times.push_back((long)(atof(vars[3])));
+                }
+                catch(const char *msg)
+                {
+                    chunk.setError(msg, row);
+                    break;
+                }
+                catch(...)
+                {
+                    chunk.setError("Unknown exception occurred when parsing CERT data.", row);
+                    break;
+                }
+            }
+        }
+    });
+    checkEdgeChunks(chunks, lineNum);
+
+    // Look up the nodes that already exist (-1 for new ones)
+    const CertGraph &cg = g;
+    Parallel::forRange(chunks.size(), 1, 1, [&](int first, int last)
+    {
+        for(int i=first; i<last; i++)
+        {
+            GdfEdgeChunk &chunk = chunks[i];
+            int m = chunk.times.size();
+            chunk.u.resize(m);
+            chunk.v.resize(m);
+            for(int j=0; j<m; j++)
+            {
+                string source = chunk.getText(chunk.sources[j]), dest = chunk.getText(chunk.dests[j]);
+                chunk.u[j] = cg.hasLabeledNode(source) ? cg.getIndex(source) : -1;
+                chunk.v[j] = cg.hasLabeledNode(dest) ? cg.getIndex(dest) : -1;
+            }
+        }
+    });
+
+    // Add the edges in file order (new nodes get added as they're first seen)
+    for(const GdfEdgeChunk &chunk : chunks)
+    {
+        for(int j=0; j<chunk.times.size(); j++)
+        {
+            const char *type = chunk.getText(chunk.types[j]);
+            if(chunk.u[j] < 0 || chunk.v[j] < 0)
+                g.addEdge(chunk.getText(chunk.sources[j]), chunk.getText(chunk.dests[j]), chunk.times[j], type);
+            else
+                g.addEdge(chunk.u[j], chunk.v[j], chunk.times[j], type);
+        }
+    }
 }
 
 CertGraph FileIO::loadCertGDFs(const std::string &folder)
@@ -322,6 +559,7 @@ CertGraph FileIO::loadCertGDFs(const std::string &folder)
         else
             cout << "Ignoring file: " << fname << endl;
     }
+    g.setStats(GraphStats::compute(g));
     
     return g;
 }
@@ -330,6 +568,7 @@ CertGraph FileIO::loadCertGDF(const std::string &fname)
 {    
     CertGraph g(0);
     FileIO::loadCertGDF(fname, g);
+    g.setStats(GraphStats::compute(g));
     return g;
 }
 
@@ -366,8 +605,7 @@ void FileIO::addNodeRestrictions(const std::string &nodeID, const std::string &r
 	    try
 	    {
 		cout << "Adding regex node restriction: \"" << var.substr(6) << "\"" << endl;
-		regex rx(var.substr(6));
-		g.addRegex(v, rx);
+		g.addRegex(v, var.substr(6));
 	    }
 	    catch(...)
 	    {
@@ -479,51 +717,58 @@ void FileIO::saveCertGDF(const CertGraph &g, const string &fname,
 DataGraph FileIO::loadGenericGDF(const string &fname)
 {
     DataGraph g;
+    MappedFile file(fname);
+    GdfState state;
+    FileIO::parseGenericGDF(file.data(), file.data() + file.size(), g, state);
+    if(state.isEdgeData == false)
+        throw "Error reading GDF file. No edgedef> section found.";
+    g.setStats(GraphStats::compute(g));
+    return g;
+}
 
-    int lineNum = 0;    
-    bool isNodeData = false, isEdgeData = false;    
-    int sourceCol = -1, destCol = -1, timeCol = -1, nameCol = -1;
-    int numNodeCols = 0, numEdgeCols = 0;
+void FileIO::parseGenericGDF(const char *begin, const char *end, DataGraph &g, GdfState &state)
+{
+    const char *p = begin;
 
-    FastReader csv(fname);
-    while(csv.good())
+    // Read the nodes, up to the start of the edge section
+    CsvRow row;
+    while(p < end && !state.isEdgeData)
     {
-        //vector<string> vars = csv.next();
-        char **vars = csv.next();
-	//cout << csv.line() << endl;
-        lineNum++;
-	if(lineNum % 100000 == 0)
-	    cout << "Parsing line #" << lineNum << endl;
-	//if(vars.empty() || (vars.size() == 1 && (vars[0].empty() || vars[0][0] == '#')))
-        int numVars = csv.rowSize();
-        if(numVars == 0 || (numVars == 1 && (vars[0][0] == '\0' || vars[0][0] == '#')))
-	{
-	    //cout << "SKIPPING COMMENT/EMPTY LINE" << endl;
-	    continue;
-	}
+        state.lineNum++;
+	if(state.lineNum % 100000 == 0)
+	    cout << "Parsing line #" << state.lineNum << endl;
 
         try
         {
-	    if(!isNodeData && !isEdgeData)
+            p = row.parse(p, end);
+            char **vars = row.vars();
+            int numVars = row.size();
+            if(numVars == 1 && (vars[0][0] == '\0' || vars[0][0] == '#'))
+                continue;
+
+	    if(!state.isNodeData)
 	    {
 		// Look to see if we reached the node data section (probably shouldn't happen)
-		//if(vars[0].size() > 8 && vars[0].substr(0,8) == "nodedef>")
                 if(strncmp(vars[0],"nodedef>",8)==0)
 		{
 		    cout << "Reading node data" << endl;
-		    isNodeData = true;
-		    isEdgeData = false;
+		    state.isNodeData = true;
 
-                    AttributesDef def = getAttributesDef(isNodeData, vars, numVars);
+                    AttributesDef def = getAttributesDef(state.isNodeData, vars, numVars);
+                    state.nameCol = -1;
                     for(int i=0; i<def.attributeNames().size(); i++)
                     {
                         if(def.attributeNames()[i] == "name")
-                            nameCol = i;
+                            state.nameCol = i;
                     }
-		    if(nameCol < 0)
+		    if(state.nameCol < 0)
 			throw "Missing \"name\" column in \"nodedef>\"";
-		    g.setNodeAttributesDef(def);
-                    numNodeCols = def.attributeNames().size();
+                    // Later files have to match the graph we already have
+                    if(g.nodeAttributesDef().attributeNames().empty())
+		        g.setNodeAttributesDef(def);
+                    else if(def != g.nodeAttributesDef())
+                        throw "Node attributes in \"nodedef>\" don't match the ones already in the graph.";
+                    state.numNodeCols = def.attributeNames().size();
 			
 		    continue;
 		}
@@ -531,93 +776,197 @@ DataGraph FileIO::loadGenericGDF(const string &fname)
 		    throw "Error reading GDF file. No nodedef> section found.";
 	    }
 
-	    if(isNodeData)
+	    // Look if we reached the edge data section
+            if(strncmp(vars[0],"edgedef>",8)==0)
 	    {
-		// Look if we reached the edge data section
-		//if(vars[0].size() > 8 && vars[0].substr(0,8) == "edgedef>")
-                if(strncmp(vars[0],"edgedef>",8)==0)
-		{
-		    cout << "Reading edge data" << endl;
-		    isNodeData = false;
-		    isEdgeData = true;
-
-		    AttributesDef def = getAttributesDef(isNodeData, vars, numVars);
-                    const auto &names = def.attributeNames();
-		    for(int i=0; i<names.size(); i++)
-		    {
-			const string &name = names[i];
-			if(name == "node1")
-			    sourceCol = i;
-			else if(name == "node2")
-			    destCol = i;
-			else if(name == "date" || name == "time")
-			    timeCol = i;			
-		    }
-		    if(sourceCol < 0)
-			throw "Missing \"node1\" column in \"edgedef>\"";
-		    if(destCol < 0)
-			throw "Missing \"node2\" column in \"edgedef>\"";
-		    if(timeCol < 0)
-			throw "Missing \"time\" column in \"edgedef>\"";
-		    numEdgeCols = names.size();
-		    g.setEdgeAttributesDef(def);
-                    
-		    continue;
-		}		    
-		if(numVars != numNodeCols)
+		cout << "Reading edge data" << endl;
+		state.isNodeData = false;
+		state.isEdgeData = true;
+
+		AttributesDef def = getAttributesDef(state.isNodeData, vars, numVars);
+                const auto &names = def.attributeNames();
+                state.sourceCol = state.destCol = state.timeCol = -1;
+		for(int i=0; i<names.size(); i++)
 		{
-		    cerr << "Number of node attributes defined = " << numNodeCols << endl;
-		    cerr << "Number of variables found = " << numVars << endl;
-		    throw "Mismatch in number of columns in node section."; 
+		    const string &name = names[i];
+		    if(name == "node1")
+			state.sourceCol = i;
+		    else if(name == "node2")
+			state.destCol = i;
+		    else if(name == "date" || name == "time")
+			state.timeCol = i;			
 		}
-
-		Attributes a;
-                FileIO::addAttributeValues(g.nodeAttributesDef(), vars, a);
-		g.addNode(vars[nameCol], a);
-	    }
-                
-	    if(isEdgeData)
-	    {	       
-		if(numVars != numEdgeCols)
-		    throw "Mismatch in number of columns in edge section.";
-
-		Attributes a;
-                FileIO::addAttributeValues(g.edgeAttributesDef(), vars, a);
-		g.addEdge(vars[sourceCol], vars[destCol], atoi(vars[timeCol]), a);
+		if(state.sourceCol < 0)
+		    throw "Missing \"node1\" column in \"edgedef>\"";
+		if(state.destCol < 0)
+		    throw "Missing \"node2\" column in \"edgedef>\"";
+		if(state.timeCol < 0)
+		    throw "Missing \"time\" column in \"edgedef>\"";
+		state.numEdgeCols = names.size();
+                if(g.edgeAttributesDef().attributeNames().empty())
+		    g.setEdgeAttributesDef(def);
+                else if(def != g.edgeAttributesDef())
+                    throw "Edge attributes in \"edgedef>\" don't match the ones already in the graph.";
+		continue;
+	    }		    
+	    if(numVars != state.numNodeCols)
+	    {
+		cerr << "Number of node attributes defined = " << state.numNodeCols << endl;
+		cerr << "Number of variables found = " << numVars << endl;
+		throw "Mismatch in number of columns in node section."; 
 	    }
-              
+
+	    Attributes a;
+            FileIO::addAttributeValues(g.nodeAttributesDef(), vars, a);
+	    g.addNode(vars[state.nameCol], a);
         }
         catch(exception &e)
         {
-            cerr << "Problem on line #" << lineNum << endl;
+            cerr << "Problem on line #" << state.lineNum << endl;
             cerr << "Problematic line: ";
-            csv.dispRow();
+            row.disp();
 	    cerr << e.what() << endl;
             throw e.what();            
         }
         catch(const char *msg)
         {
-            cerr << "Problem on line #" << lineNum << endl;
+            cerr << "Problem on line #" << state.lineNum << endl;
             cerr << "Problematic line: ";
-            csv.dispRow();
+            row.disp();
 	    cerr << msg << endl;
             throw msg;            
         }
         catch(...)
         {
-            cerr << "Problem on line #" << lineNum << endl;
+            cerr << "Problem on line #" << state.lineNum << endl;
             cerr << "Problematic line: ";
-            csv.dispRow();
+            row.disp();
 	    cerr << "Unknown exception" << endl;
             throw "Unknown exception occurred when parsing GDF data.";
         }
     }
-    csv.close();
-    //cout << "Done reading data" << endl;
-    if(isEdgeData == false)
-        throw "Error reading GDF file. No edgedef> section found.";
+    if(p >= end)
+        return;
 
-    return g;
+    // Parse pieces of the edge section on all cores, each into its own
+    // attribute columns
+    vector<GdfEdgeChunk> chunks = splitEdgeSection(p, end);
+    const AttributesDef &edgeDef = g.edgeAttributesDef();
+    const int sourceCol = state.sourceCol, destCol = state.destCol, timeCol = state.timeCol;
+    const int numEdgeCols = state.numEdgeCols;
+    Parallel::forRange(chunks.size(), 1, 1, [&](int first, int last)
+    {
+        CsvRow row;
+        for(int i=first; i<last; i++)
+        {
+            GdfEdgeChunk &chunk = chunks[i];
+            chunk.columns.setDef(edgeDef);
+            const char *q = chunk.begin;
+            while(q < chunk.end)
+            {
+                chunk.numLines++;
+                try
+                {
+                    q = row.parse(q, chunk.end);
+                    char **vars = row.vars();
+                    int numVars = row.size();
+                    if(numVars == 1 && (vars[0][0] == '\0' || vars[0][0] == '#'))
+                        continue;
+                    if(numVars != numEdgeCols)
+                        throw "Mismatch in number of columns in edge section.";
+
+                    Attributes a;
+                    FileIO::addAttributeValues(edgeDef, vars, a);
+                    chunk.sources.push_back(chunk.addText(vars[sourceCol]));
+                    chunk.dests.push_back(chunk.addText(vars[destCol]));
+                    chunk.times.push_back(atoi(vars[timeCol]));
+                    chunk.columns.add(a);
+                }
+                catch(const char *msg)
+                {
+                    chunk.setError(msg, row);
+                    break;
+                }
+                catch(...)
+                {
+                    chunk.setError("Unknown exception occurred when parsing GDF data.", row);
+                    break;
+                }
+            }
+        }
+    });
+    checkEdgeChunks(chunks, state.lineNum);
+    for(const GdfEdgeChunk &chunk : chunks)
+        state.lineNum += chunk.numLines;
+
+    // Files without a node section add the nodes as their edges name them
+    if(state.addsNodes)
+    {
+        const AttributesDef &nodeDef = g.nodeAttributesDef();
+        vector<char*> blanks(nodeDef.attributeNames().size(), (char*)"");
+        Attributes blank;
+        FileIO::addAttributeValues(nodeDef, blanks.data(), blank);
+        for(const GdfEdgeChunk &chunk : chunks)
+        {
+            for(int j=0; j<chunk.times.size(); j++)
+            {
+                for(const char *name : {chunk.getText(chunk.sources[j]), chunk.getText(chunk.dests[j])})
+                {
+                    if(!g.hasNode(name))
+                        g.addNode(name, blank);
+                }
+            }
+        }
+    }
+
+    // Resolve the node names (which don't change while adding edges) in parallel
+    Parallel::forRange(chunks.size(), 1, 1, [&](int first, int last)
+    {
+        for(int i=first; i<last; i++)
+        {
+            GdfEdgeChunk &chunk = chunks[i];
+            int m = chunk.times.size();
+            chunk.u.resize(m);
+            chunk.v.resize(m);
+            for(int j=0; j<m; j++)
+            {
+                chunk.u[j] = g.findNode(chunk.getText(chunk.sources[j]));
+                chunk.v[j] = g.findNode(chunk.getText(chunk.dests[j]));
+            }
+        }
+    });
+
+    // Add the edges in file order, except the ones that are already in the graph
+    for(GdfEdgeChunk &chunk : chunks)
+    {
+        int m = chunk.times.size();
+        int64_t skip = max((int64_t)0, min((int64_t)m, state.numEdgesToSkip - state.numEdges));
+        state.numEdges += m;
+        if(skip == m)
+            continue;
+        if(skip > 0)
+        {
+            chunk.u.erase(chunk.u.begin(), chunk.u.begin() + skip);
+            chunk.v.erase(chunk.v.begin(), chunk.v.begin() + skip);
+            chunk.times.erase(chunk.times.begin(), chunk.times.begin() + skip);
+            chunk.columns.removeFirst(skip);
+        }
+        g.appendEdges(chunk.u, chunk.v, chunk.times, chunk.columns);
+    }
+}
+
+void FileIO::startCsvEdges(const string &edgeColumns, DataGraph &g, GdfState &state)
+{
+    // Same as the edge section of a GDF file (the nodes only have names,
+    // unless the graph already has other attributes for them)
+    string header = "edgedef>" + edgeColumns + "\n";
+    if(g.nodeAttributesDef().attributeNames().empty())
+        header = "nodedef>name VARCHAR\n" + header;
+    else
+        state.isNodeData = true;
+    FileIO::parseGenericGDF(header.data(), header.data() + header.size(), g, state);
+    state.lineNum = 0;
+    state.addsNodes = true;
 }
 
 void FileIO::saveGenericGDF(const DataGraph &g, const string &fname)
@@ -638,7 +987,7 @@ void FileIO::saveGenericGDF(const DataGraph &g, const string &fname)
     int n = g.nodes().size();
     for(int u=0; u<n; u++)
     {
-        const Attributes &a = g.nodeAttributes()[u];
+        Attributes a = g.nodeAttributes(u);
         int si=0, ii=0, fi=0; // Indices into string values, int values, float values
 	for(int i=0; i<numNodeAtts; i++)
 	{
@@ -687,7 +1036,7 @@ void FileIO::saveGenericGDF(const DataGraph &g, const string &fname)
     for(int e=0; e<m; e++)
     {
         const Edge &edge = g.edges()[e];
-	const Attributes &a = g.edgeAttributes()[e];
+	Attributes a = g.edgeAttributes(e);
         int si=0, ii=0, fi=0; // Indices into string values, int values, float values
 	for(int i=0; i<numEdgeAtts; i++)
 	{
@@ -738,6 +1087,232 @@ void FileIO::saveGenericGDF(const DataGraph &g, const string &fname)
     ofs.close();
 }
 
+void FileIO::saveSnapshot(const DataGraph &g, const string &fname)
+{
+    const EdgeList &edges = g.edges();
+    int n = g.numNodes();
+    int m = g.numEdges();
+    const AttributeColumns &nodeColumns = g.nodeColumns();
+    const AttributeColumns &edgeColumns = g.edgeColumns();
+    if(nodeColumns.hasRestrictions() || edgeColumns.hasRestrictions())
+        throw "Can't save a snapshot of a graph with attribute restrictions.";
+    if(nodeColumns.size() != n)
+        throw "Can't save a snapshot. Not every node has attributes.";
+
+    ofstream ofs(fname, ios::binary);
+    if(!ofs.good())
+        throw "Unable to open the snapshot file for writing.";
+
+    // Header is filled in at the end
+    SnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    ofs.write((const char*)&header, sizeof(header));
+    SnapshotWriter writer(ofs);
+
+    writer.write(saveAttributesDef(g.nodeAttributesDef()));
+    writer.write(saveAttributesDef(g.edgeAttributesDef()));
+
+    // Edges, already in chronological order
+    vector<int32_t> sources(m), dests(m);
+    vector<int64_t> times(m);
+    for(int e=0; e<m; e++)
+    {
+        sources[e] = edges[e].source();
+        dests[e] = edges[e].dest();
+        times[e] = edges[e].time();
+    }
+    writer.write(sources);
+    writer.write(dests);
+    writer.write(times);
+
+    // Adjacency lists
+    vector<int64_t> outOffsets(1, 0), inOffsets(1, 0);
+    vector<int32_t> outEdges, inEdges;
+    outEdges.reserve(m);
+    inEdges.reserve(m);
+    for(int v=0; v<n; v++)
+    {
+        const Node &node = g.nodes()[v];
+        outEdges.insert(outEdges.end(), node.outEdges().begin(), node.outEdges().end());
+        inEdges.insert(inEdges.end(), node.inEdges().begin(), node.inEdges().end());
+        outOffsets.push_back(outEdges.size());
+        inOffsets.push_back(inEdges.size());
+    }
+    writer.write(outOffsets);
+    writer.write(outEdges);
+    writer.write(inOffsets);
+    writer.write(inEdges);
+
+    // Node names and their index
+    const NodeNames &names = g._nodeNames;
+    if(names.size() != n)
+        throw "Can't save a snapshot. Not every node has a name.";
+    vector<int64_t> nameOffsets(1, 0);
+    string nameChars;
+    for(int v=0; v<n; v++)
+    {
+        nameChars += names.get(v);
+        nameOffsets.push_back(nameChars.size());
+    }
+    writer.write(nameOffsets);
+    writer.write(nameChars);
+    writer.write(names.createIndex());
+
+    // Attribute columns (nodes then edges)
+    for(const AttributeColumns *columns : {&nodeColumns, &edgeColumns})
+    {
+        int rows = columns->size();
+        for(int k=0; k<columns->numIntColumns(); k++)
+            writer.write(columns->intColumn(k), rows * sizeof(int));
+        for(int k=0; k<columns->numFloatColumns(); k++)
+            writer.write(columns->floatColumn(k), rows * sizeof(float));
+        for(int k=0; k<columns->numStringColumns(); k++)
+        {
+            writer.write(columns->stringColumn(k), rows * sizeof(int));
+            vector<int64_t> dictOffsets(1, 0);
+            string dictChars;
+            for(int code=0; code<columns->numStringValues(k); code++)
+            {
+                dictChars += columns->stringValue(k, code);
+                dictOffsets.push_back(dictChars.size());
+            }
+            writer.write(dictOffsets);
+            writer.write(dictChars);
+        }
+    }
+
+    // Statistics, so they don't have to be computed again
+    if(g.stats() != NULL)
+        writer.write(saveStats(*g.stats()));
+    else
+        writer.write(saveStats(GraphStats::compute(g)));
+
+    memcpy(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic));
+    header.version = SNAPSHOT_VERSION;
+    header.byteOrder = BYTE_ORDER_MARK;
+    header.numNodes = n;
+    header.numEdges = m;
+    header.numSections = writer.numSections();
+    header.directoryOffset = writer.finish();
+    ofs.seekp(0);
+    ofs.write((const char*)&header, sizeof(header));
+    ofs.close();
+    if(ofs.fail())
+        throw "Error writing the snapshot file.";
+}
+
+DataGraph FileIO::loadSnapshot(const string &fname)
+{
+    shared_ptr<MappedFile> file = make_shared<MappedFile>(fname);
+    if(file->size() < sizeof(SnapshotHeader))
+        throw "Snapshot file is too small.";
+    const SnapshotHeader &header = *(const SnapshotHeader*)file->data();
+    if(memcmp(header.magic, SNAPSHOT_MAGIC, sizeof(header.magic)) != 0)
+        throw "Not a snapshot file.";
+    if(header.byteOrder != BYTE_ORDER_MARK)
+        throw "Snapshot file was saved on a machine with a different byte order.";
+    if(header.version < 1 || header.version > SNAPSHOT_VERSION)
+        throw "Unsupported snapshot file version.";
+    if(header.numSections < 0 || header.directoryOffset < 0 ||
+       header.directoryOffset + header.numSections * (int64_t)sizeof(SnapshotSection) > (int64_t)file->size())
+        throw "Snapshot file is corrupt or truncated.";
+
+    int n = header.numNodes;
+    int m = header.numEdges;
+    SnapshotReader reader(*file, (const SnapshotSection*)(file->data() + header.directoryOffset), header.numSections);
+
+    DataGraph g;
+    g.setNodeAttributesDef(loadAttributesDef(reader.nextString()));
+    g.setEdgeAttributesDef(loadAttributesDef(reader.nextString()));
+
+    const int32_t *sources = reader.next<int32_t>(m);
+    const int32_t *dests = reader.next<int32_t>(m);
+    const int64_t *times = reader.next<int64_t>(m);
+    const int64_t *outOffsets = reader.next<int64_t>(n+1);
+    const int32_t *outEdges = reader.next<int32_t>(outOffsets[n]);
+    const int64_t *inOffsets = reader.next<int64_t>(n+1);
+    const int32_t *inEdges = reader.next<int32_t>(inOffsets[n]);
+
+    const int64_t *nameOffsets = reader.next<int64_t>(n+1);
+    const char *nameChars = reader.next<char>(nameOffsets[n]);
+    int64_t indexBytes;
+    const int32_t *nameIndex = (const int32_t*)reader.nextChars(indexBytes);
+    g._nodeNames.setView(file, n, nameOffsets, nameChars, nameIndex, indexBytes / sizeof(int32_t));
+
+    // Attribute columns (nodes then edges)
+    for(int i=0; i<2; i++)
+    {
+        const AttributesDef &def = i == 0 ? g.nodeAttributesDef() : g.edgeAttributesDef();
+        int rows = i == 0 ? n : m;
+        vector<const int*> ints;
+        vector<const float*> floats;
+        vector<const int*> strings;
+        vector<vector<string>> dicts;
+        for(int k=0; k<def.numIntValues(); k++)
+            ints.push_back(reader.next<int>(rows));
+        for(int k=0; k<def.numFloatValues(); k++)
+            floats.push_back(reader.next<float>(rows));
+        for(int k=0; k<def.numStringValues(); k++)
+        {
+            strings.push_back(reader.next<int>(rows));
+            int64_t numOffsets;
+            const int64_t *dictOffsets = (const int64_t*)reader.nextChars(numOffsets);
+            numOffsets /= sizeof(int64_t);
+            if(numOffsets < 1)
+                throw "Snapshot file is corrupt (missing dictionary).";
+            const char *dictChars = reader.next<char>(dictOffsets[numOffsets-1]);
+            dicts.push_back(vector<string>());
+            for(int code=0; code+1<numOffsets; code++)
+                dicts.back().push_back(string(dictChars + dictOffsets[code], dictOffsets[code+1] - dictOffsets[code]));
+        }
+        if(i == 0)
+            g._nodeColumns.setView(file, rows, ints, floats, strings, dicts);
+        else
+        {
+            // Edges are already in chronological order, so both are the same
+            g._insertedEdgeColumns.setView(file, rows, ints, floats, strings, dicts);
+            g._edgeColumns.setDef(def);
+            g._edgeColumns.setView(file, rows, ints, floats, strings, dicts);
+        }
+    }
+
+    g.setOrderedEdges(n, m, sources, dests, times, outOffsets, outEdges, inOffsets, inEdges);
+
+    // (version 1 snapshots don't have the statistics)
+    if(header.version >= 2)
+        g.setStats(loadStats(reader.nextString()));
+    else
+        g.setStats(GraphStats::compute(g));
+    return g;
+}
+
+bool FileIO::isSnapshot(const string &fname)
+{
+    ifstream ifs(fname, ios::binary);
+    char magic[sizeof(SNAPSHOT_MAGIC)];
+    ifs.read(magic, sizeof(magic));
+    return ifs.good() && memcmp(magic, SNAPSHOT_MAGIC, sizeof(magic)) == 0;
+}
+
+string FileIO::saveAttributesDef(const AttributesDef &def)
+{
+    stringstream ss;
+    for(int i=0; i<def.attributeNames().size(); i++)
+        ss << (int)def.attributeTypes()[i] << " " << (int)def.dataTypes()[i] << " " << def.attributeNames()[i] << endl;
+    return ss.str();
+}
+
+AttributesDef FileIO::loadAttributesDef(const string &str)
+{
+    AttributesDef def;
+    stringstream ss(str);
+    int attType, dataType;
+    string name;
+    while(ss >> attType >> dataType >> name)
+        def.addAttribute((AttributeType)attType, (DataType)dataType, name);
+    return def;
+}
+
 void FileIO::saveNodeCount(const LabeledWeightedGraph &g, const vector<GraphMatch> &subgraphs, 
 			   const LabeledWeightedGraph &h, const unordered_map<string,vector<int>> &timeCounts, 
 			   int numTimeSlices, time_t startTime, time_t endTime, const string &fname)
@@ -863,6 +1438,394 @@ void FileIO::saveQueryGraph(const CertGraph &query, const vector<GraphMatch> &su
     FileIO::saveCertGDF(query, fname, edgeData, nodeData);
 }
 
+namespace
+{
+    /** Just enough of JSON for the config and GraphInfo files */
+    struct JsonValue
+    {
+        enum Type { NUL, BOOL, NUMBER, STRING, ARRAY, OBJECT };
+        Type type = NUL;
+        bool boolean = false;
+        double number = 0;
+        std::string str;
+        std::vector<JsonValue> items;
+        std::vector<std::pair<std::string,JsonValue>> members;
+
+        /** Member with the given name, or NULL if there isn't one */
+        const JsonValue *find(const std::string &name) const
+        {
+            for(const auto &member : members)
+                if(member.first == name)
+                    return &member.second;
+            return NULL;
+        }
+        /** Number (or a number in a string, such as "3600") */
+        time_t asTime() const { return type == STRING ? atol(str.c_str()) : (time_t)number; }
+    };
+
+    class JsonParser
+    {
+    public:
+        JsonParser(const std::string &text) : _text(text), _pos(0) {}
+        JsonValue parse()
+        {
+            JsonValue value = parseValue();
+            skipSpace();
+            if(_pos < _text.size())
+                throw "Unexpected characters after the end of the JSON data.";
+            return value;
+        }
+    private:
+        void skipSpace()
+        {
+            while(_pos < _text.size() && isspace((unsigned char)_text[_pos]))
+                _pos++;
+        }
+        bool next(char c)
+        {
+            skipSpace();
+            if(_pos < _text.size() && _text[_pos] == c)
+            {
+                _pos++;
+                return true;
+            }
+            return false;
+        }
+        void expect(char c)
+        {
+            if(!next(c))
+                throw "Invalid JSON format.";
+        }
+        bool nextWord(const char *word)
+        {
+            size_t len = strlen(word);
+            if(_text.compare(_pos, len, word) != 0)
+                return false;
+            _pos += len;
+            return true;
+        }
+        std::string parseString()
+        {
+            expect('"');
+            std::string str;
+            while(_pos < _text.size() && _text[_pos] != '"')
+            {
+                char c = _text[_pos++];
+                if(c == '\\' && _pos < _text.size())
+                {
+                    c = _text[_pos++];
+                    if(c == 'n') c = '\n';
+                    else if(c == 't') c = '\t';
+                    else if(c == 'r') c = '\r';
+                    else if(c == 'u')
+                    {
+                        // (Only ASCII characters are expected)
+                        c = (char)strtol(_text.substr(_pos, 4).c_str(), NULL, 16);
+                        _pos += 4;
+                    }
+                }
+                str += c;
+            }
+            expect('"');
+            return str;
+        }
+        JsonValue parseValue()
+        {
+            JsonValue value;
+            skipSpace();
+            if(_pos >= _text.size())
+                throw "Unexpected end of JSON data.";
+            char c = _text[_pos];
+            if(c == '{')
+            {
+                _pos++;
+                value.type = JsonValue::OBJECT;
+                if(next('}'))
+                    return value;
+                do
+                {
+                    std::string name = parseString();
+                    expect(':');
+                    value.members.push_back(make_pair(name, parseValue()));
+                } while(next(','));
+                expect('}');
+            }
+            else if(c == '[')
+            {
+                _pos++;
+                value.type = JsonValue::ARRAY;
+                if(next(']'))
+                    return value;
+                do
+                {
+                    value.items.push_back(parseValue());
+                } while(next(','));
+                expect(']');
+            }
+            else if(c == '"')
+            {
+                value.type = JsonValue::STRING;
+                value.str = parseString();
+            }
+            else if(nextWord("true") || nextWord("false"))
+            {
+                value.type = JsonValue::BOOL;
+                value.boolean = c == 't';
+            }
+            else if(nextWord("null"))
+                value.type = JsonValue::NUL;
+            else
+            {
+                const char *start = _text.c_str() + _pos;
+                char *end;
+                value.type = JsonValue::NUMBER;
+                value.number = strtod(start, &end);
+                if(end == start)
+                    throw "Invalid JSON format.";
+                _pos += end - start;
+            }
+            return value;
+        }
+
+        const std::string &_text;
+        size_t _pos;
+    };
+
+    /** Writes the string in quotes, escaping anything that needs it */
+    void writeJsonString(std::ostream &os, const std::string &str)
+    {
+        os << '"';
+        for(char c : str)
+        {
+            if(c == '"' || c == '\\')
+                os << '\\' << c;
+            else if(c == '\n')
+                os << "\\n";
+            else if((unsigned char)c < 0x20)
+                os << "\\u00" << "0123456789abcdef"[(c >> 4) & 0xF] << "0123456789abcdef"[c & 0xF];
+            else
+                os << c;
+        }
+        os << '"';
+    }
+}
+
+void FileIO::saveStatsReport(const GraphStats &stats, const string &jsonFname)
+{
+    ofstream ofs(jsonFname);
+    if(!ofs.is_open())
+        throw "Unable to save the graph statistics file.";
+    ofs << saveStats(stats);
+    ofs.close();
+}
+
+string FileIO::saveStats(const GraphStats &stats)
+{
+    auto writeHistogram = [](ostream &os, const vector<int64_t> &histogram)
+    {
+        os << "[";
+        for(int b=0; b<histogram.size(); b++)
+            os << (b > 0 ? ", " : "") << histogram[b];
+        os << "]";
+    };
+
+    stringstream ss;
+    ss << "{" << endl;
+    ss << "  \"nodes\": " << stats.numNodes << "," << endl;
+    ss << "  \"edges\": " << stats.numEdges << "," << endl;
+    ss << "  \"startTime\": " << stats.startTime << "," << endl;
+    ss << "  \"endTime\": " << stats.endTime << "," << endl;
+    ss << "  \"meanDegree\": " << stats.meanDegree() << "," << endl;
+    ss << "  \"edgesPerSecond\": " << stats.edgesPerSecond() << "," << endl;
+    ss << "  \"degreeHistograms\": {";
+    bool first = true;
+    for(const auto &histogram : stats.degreeHistograms)
+    {
+        ss << (first ? "" : ",") << endl << "    ";
+        writeJsonString(ss, histogram.first);
+        ss << ": ";
+        writeHistogram(ss, histogram.second);
+        first = false;
+    }
+    ss << endl << "  }," << endl;
+    ss << "  \"edgeValueCounts\": {";
+    first = true;
+    for(const auto &attribute : stats.edgeValueCounts)
+    {
+        ss << (first ? "" : ",") << endl << "    ";
+        writeJsonString(ss, attribute.first);
+        ss << ": {";
+        bool firstValue = true;
+        for(const auto &count : attribute.second)
+        {
+            ss << (firstValue ? "" : ", ");
+            writeJsonString(ss, count.first);
+            ss << ": " << count.second;
+            firstValue = false;
+        }
+        ss << "}";
+        first = false;
+    }
+    ss << endl << "  }," << endl;
+    ss << "  \"interEventTimes\": ";
+    writeHistogram(ss, stats.interEventTimes);
+    ss << "," << endl << "  \"nodeInterEventTimes\": ";
+    writeHistogram(ss, stats.nodeInterEventTimes);
+    ss << "," << endl << "  \"busiestNodes\": [";
+    for(int i=0; i<stats.busiestNodes.size(); i++)
+    {
+        ss << (i > 0 ? ", " : "") << "[";
+        writeJsonString(ss, stats.busiestNodes[i].first);
+        ss << ", " << stats.busiestNodes[i].second << "]";
+    }
+    ss << "]" << endl << "}" << endl;
+    return ss.str();
+}
+
+GraphStats FileIO::loadStats(const string &str)
+{
+    JsonValue root = JsonParser(str).parse();
+    if(root.type != JsonValue::OBJECT)
+        throw "The graph statistics must be a JSON object.";
+    auto readHistogram = [](const JsonValue *value, vector<int64_t> &histogram)
+    {
+        histogram.clear();
+        if(value != NULL)
+            for(const JsonValue &item : value->items)
+                histogram.push_back((int64_t)item.number);
+    };
+
+    GraphStats stats;
+    const JsonValue *value;
+    if((value = root.find("nodes")))
+        stats.numNodes = (int64_t)value->number;
+    if((value = root.find("edges")))
+        stats.numEdges = (int64_t)value->number;
+    if((value = root.find("startTime")))
+        stats.startTime = value->asTime();
+    if((value = root.find("endTime")))
+        stats.endTime = value->asTime();
+    if((value = root.find("degreeHistograms")))
+        for(const auto &member : value->members)
+            readHistogram(&member.second, stats.degreeHistograms[member.first]);
+    if((value = root.find("edgeValueCounts")))
+        for(const auto &attribute : value->members)
+            for(const auto &count : attribute.second.members)
+                stats.edgeValueCounts[attribute.first][count.first] = (int64_t)count.second.number;
+    readHistogram(root.find("interEventTimes"), stats.interEventTimes);
+    readHistogram(root.find("nodeInterEventTimes"), stats.nodeInterEventTimes);
+    if((value = root.find("busiestNodes")))
+        for(const JsonValue &node : value->items)
+            if(node.items.size() == 2)
+                stats.busiestNodes.push_back(make_pair(node.items[0].str, (int64_t)node.items[1].number));
+    return stats;
+}
+
+void FileIO::saveGraphInfo(const Graph &g, time_t rangeStart, time_t rangeEnd, const unordered_map<string,int> &queryCounts, const SearchConfig &config, const vector<pair<string,string>> &selEdges, const string &jsonFname)
+{
+    // Write a temporary file first, so nothing reading the file ever sees half of it
+    string tmpFname = jsonFname + ".tmp";
+    ofstream ofs(tmpFname);
+    if(!ofs.is_open())
+        throw "Unable to save the graph info file.";
+
+    ofs << "{" << endl;
+    ofs << "  \"" << NUM_NODES << "\": " << g.numNodes() << "," << endl;
+    ofs << "  \"" << NUM_LINKS << "\": " << g.numEdges() - g.firstEdge() << "," << endl;
+    ofs << "  \"" << START_DATE << "\": " << rangeStart << "," << endl;
+    ofs << "  \"" << END_DATE << "\": " << rangeEnd << "," << endl;
+    ofs << "  \"" << DELTA << "\": " << config.delta << "," << endl;
+    ofs << "  \"" << STREAM_SECTION << "\": { \"" << IS_STREAMING << "\": " << (config.useStreaming ? "true" : "false");
+    ofs << ", \"" << STREAM_DUR << "\": " << config.duration << ", \"" << STREAM_DELAY << "\": " << config.delay;
+    ofs << ", \"" << STREAM_WIN << "\": " << config.window << " }," << endl;
+
+    // Sorted by name, so the order doesn't change between saves
+    map<string,int> counts(queryCounts.begin(), queryCounts.end());
+    ofs << "  \"" << QUERIES_SECTION << "\": {";
+    bool first = true;
+    for(const auto &count : counts)
+    {
+        ofs << (first ? "" : ",") << endl << "    ";
+        writeJsonString(ofs, count.first);
+        ofs << ": " << count.second;
+        first = false;
+    }
+    ofs << endl << "  }," << endl;
+
+    ofs << "  \"" << SEL_SUBGRAPHS_SECTION << "\": {" << endl;
+    ofs << "    \"" << QUERY << "\": ";
+    writeJsonString(ofs, config.find_subgraphs_query);
+    ofs << "," << endl << "    \"" << NODES << "\": [";
+    for(int i=0; i<config.find_subgraphs_nodes.size(); i++)
+    {
+        ofs << (i > 0 ? ", " : "");
+        writeJsonString(ofs, config.find_subgraphs_nodes[i]);
+    }
+    ofs << "]," << endl << "    \"" << LINKS << "\": [";
+    for(int i=0; i<selEdges.size(); i++)
+    {
+        ofs << (i > 0 ? "," : "") << endl << "      [";
+        writeJsonString(ofs, selEdges[i].first);
+        ofs << ", ";
+        writeJsonString(ofs, selEdges[i].second);
+        ofs << "]";
+    }
+    ofs << endl << "    ]" << endl << "  }" << endl;
+    ofs << "}" << endl;
+    ofs.close();
+
+    if(rename(tmpFname.c_str(), jsonFname.c_str()) != 0)
+        throw "Unable to save the graph info file.";
+}
+
+void FileIO::loadConfig(const string &jsonFname, SearchConfig &config)
+{
+    ifstream ifs(jsonFname);
+    if(!ifs.is_open())
+        throw "Unable to open the config file.";
+    stringstream ss;
+    ss << ifs.rdbuf();
+    string text = ss.str();
+    JsonValue root = JsonParser(text).parse();
+    if(root.type != JsonValue::OBJECT)
+        throw "The config file must contain a JSON object.";
+
+    // Anything that isn't in the file is left as is
+    const JsonValue *value;
+    if(const JsonValue *stream = root.find(STREAM_SECTION))
+    {
+        if((value = stream->find(IS_STREAMING)))
+            config.useStreaming = value->boolean;
+        if((value = stream->find(STREAM_DUR)))
+            config.duration = value->asTime();
+        if((value = stream->find(STREAM_DELAY)))
+            config.delay = value->asTime();
+        if((value = stream->find(STREAM_WIN)))
+            config.window = value->asTime();
+        if((value = stream->find(CSV_COLUMNS)))
+            config.csvColumns = value->str;
+        if((value = stream->find(CSV_HEADER)))
+            config.csvHeader = value->boolean;
+    }
+    if((value = root.find(DELTA)))
+        config.delta = value->asTime();
+    if((value = root.find(START_DATE)))
+        config.startDate = value->asTime();
+    if((value = root.find(END_DATE)))
+        config.endDate = value->asTime();
+    if(const JsonValue *find = root.find(FIND_SUBGRAPHS_SECTION))
+    {
+        if((value = find->find(QUERY)))
+            config.find_subgraphs_query = value->str;
+        if((value = find->find(NODES)))
+        {
+            config.find_subgraphs_nodes.clear();
+            for(const JsonValue &node : value->items)
+                config.find_subgraphs_nodes.push_back(node.str);
+        }
+    }
+}
+
 vector<string> FileIO::getFileNames(const string &folder)
 {
     string folderName = folder;
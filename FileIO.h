@@ -13,8 +13,10 @@
 #include "LabeledWeightedGraph.h"
 #include "CertGraph.h"
 #include "GraphMatch.h"
+#include "GraphStats.h"
 #include "Roles.h"
 #include "SearchConfig.h"
+#include <stdint.h>
 #include <time.h>
 #include <fstream>
 #include <iostream>
@@ -89,6 +91,52 @@ public:
      */
     static DataGraph loadGenericGDF(const std::string &fname);
 
+    /** Where we are in a GDF file that's parsed one piece at a time */
+    struct GdfState
+    {
+        GdfState() : lineNum(0), isNodeData(false), isEdgeData(false), sourceCol(-1), destCol(-1), 
+                     timeCol(-1), nameCol(-1), numNodeCols(0), numEdgeCols(0),
+                     numEdges(0), numEdgesToSkip(0), addsNodes(false) {}
+        int lineNum;
+        bool isNodeData, isEdgeData;
+        int sourceCol, destCol, timeCol, nameCol;
+        int numNodeCols, numEdgeCols;
+        /** Number of edge rows parsed so far (including skipped ones) */
+        int64_t numEdges;
+        /** Number of edge rows at the start of the file that are already in
+         * the graph, and shouldn't be added again (e.g., when re-reading a
+         * file that was rewritten) */
+        int64_t numEdgesToSkip;
+        /** True if nodes that aren't in the graph yet are added (with blank
+         * attributes) when an edge names them, for files without a node
+         * section (see startCsvEdges()) */
+        bool addsNodes;
+    };
+
+    /**
+     * Parses a piece of a generic GDF file, continuing from where the 
+     * previous piece of the file left off, and adds its nodes and edges to
+     * the graph.  The edges are parsed on all cores.
+     * If the graph already has attribute definitions (e.g., from an earlier
+     * file), the ones in the file must match them.
+     * @param begin  Start of the piece (the start of a line).
+     * @param end  End of the piece (the end of a line, or the end of the file).
+     * @param g  Graph to add the nodes and edges to.
+     * @param state  Where we are in the file (updated after the piece is parsed).
+     */
+    static void parseGenericGDF(const char *begin, const char *end, DataGraph &g, GdfState &state);
+
+    /**
+     * Sets up the state for parsing a CSV file of edges with parseGenericGDF(),
+     * as if it were the edge section of a GDF file.  The nodes are added as
+     * the edges name them.
+     * @param edgeColumns  The file's columns, as on a GDF "edgedef>" line (the
+     * source, destination and time have to be called node1, node2 and time).
+     * @param g  Graph the edges will be added to.
+     * @param state  State for the start of the file.
+     */
+    static void startCsvEdges(const std::string &edgeColumns, DataGraph &g, GdfState &state);
+
     /**
      * Saves the given attributed graph in the standard GDF file format.
      * @param g  Graph we want to save.
@@ -96,6 +144,39 @@ public:
      */
     static void saveGenericGDF(const DataGraph &g, const std::string &fname);
 
+    /**
+     * Saves the graph in our binary snapshot format, which can be loaded
+     * much faster than a GDF file.  The file has edges in chronological order,
+     * CSR adjacency lists, attribute columns and their string dictionaries, 
+     * the node names along with a hash table index of them, and the graph's
+     * statistics.
+     * @param g  Graph we want to save (can't have attribute restrictions).
+     * @param fname  Name of the snapshot file to save it to.
+     */
+    static void saveSnapshot(const DataGraph &g, const std::string &fname);
+
+    /**
+     * Loads a graph saved with saveSnapshot().  The file is memory mapped,
+     * and the attribute columns and node names are used straight from the
+     * mapping (so they're only read from disk as they're needed, and 
+     * processes loading the same snapshot share one copy in the page cache).
+     * @param fname  Name of the snapshot file.
+     * @return A DataGraph object containing our graph.
+     */
+    static DataGraph loadSnapshot(const std::string &fname);
+
+    /**
+     * Returns true if the file is a snapshot saved by saveSnapshot().
+     */
+    static bool isSnapshot(const std::string &fname);
+
+    /**
+     * Saves the graph statistics as a JSON report.
+     * @param stats  Statistics of the graph (see GraphStats).
+     * @param jsonFname  Name of the JSON file to save them to.
+     */
+    static void saveStatsReport(const GraphStats &stats, const std::string &jsonFname);
+
     /**
      * Saves a CSV file with the number of times each node is encountered
      * in one of the matching subgraphs (for nodes with > 0 counts).
@@ -131,10 +212,11 @@ public:
      * @param selEdges  Edges we want to save for highlighting in the GraphInfo file.
      * @param jsonFname  Name of the JSON file to save info to.
      */
-    static void saveGraphInfo(const CertGraph &g, time_t rangeStart, time_t rangeEnd, const std::unordered_map<std::string,int> &queryCounts, const SearchConfig &config, const std::vector<std::pair<std::string,std::string>> &selEdges, const std::string &jsonFname);
+    static void saveGraphInfo(const Graph &g, time_t rangeStart, time_t rangeEnd, const std::unordered_map<std::string,int> &queryCounts, const SearchConfig &config, const std::vector<std::pair<std::string,std::string>> &selEdges, const std::string &jsonFname);
 
     /**
-     * Loads the config settings from the given JSON file.
+     * Loads the config settings from the given JSON file.  Settings that 
+     * aren't in the file are left as they are.
      */
     static void loadConfig(const std::string &jsonFname, SearchConfig &config);
 
@@ -177,6 +259,14 @@ private:
     static void saveAttributesHeader(const AttributesDef &def, std::ofstream &ofs);
     
     static void addAttributeValues(const AttributesDef &def, char **vars, Attributes &a);
+
+    static std::string saveAttributesDef(const AttributesDef &def);
+
+    static AttributesDef loadAttributesDef(const std::string &str);
+
+    static std::string saveStats(const GraphStats &stats);
+
+    static GraphStats loadStats(const std::string &str);
     
     // Constants for loading/saving JSON files
     static const std::string STREAM_SECTION;
@@ -184,6 +274,8 @@ private:
     static const std::string STREAM_DUR;
     static const std::string STREAM_DELAY;
     static const std::string STREAM_WIN;
+    static const std::string CSV_COLUMNS;
+    static const std::string CSV_HEADER;
     static const std::string DELTA;
     static const std::string NUM_NODES;
     static const std::string NUM_LINKS;
@@ -193,6 +285,9 @@ private:
     static const std::string SEL_SUBGRAPHS_SECTION;
     static const std::string FIND_SUBGRAPHS_SECTION;
     static const std::string QUERY, NODES, LINKS;
+    // Snapshot file identification
+    static const char SNAPSHOT_MAGIC[8];
+    static const uint32_t SNAPSHOT_VERSION;
 };
 
 #endif	/* FILEIO_H */
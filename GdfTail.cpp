@@ -0,0 +1,130 @@
+#include "GdfTail.h"
+#include <sys/stat.h>
+#include <string.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <utility>
+
+using namespace std;
+
+GdfTail::GdfTail(const string &path, const string &csvColumns, bool csvHeader)
+    : _path(path), _csvColumns(csvColumns), _csvHeader(csvHeader)
+{
+    struct stat st;
+    _isFolder = stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+    if(!_isFolder)
+        this->addFile(path);
+}
+
+void GdfTail::addFile(const string &fname)
+{
+    TailFile file;
+    file.fname = fname;
+    file.isCsv = fname.size() >= 4 && fname.compare(fname.size() - 4, 4, ".csv") == 0;
+    file.offset = 0;
+    if(file.isCsv && _csvColumns.empty())
+        throw "Can't follow CSV files without their columns (\"csvColumns\" in the config's \"stream\" section).";
+    _files.push_back(file);
+}
+
+int GdfTail::poll(DataGraph &g)
+{
+    int numEdges = g.numEdges();
+    if(_isFolder)
+        this->findNewFiles();
+    for(TailFile &file : _files)
+        this->readFile(file, g);
+    return g.numEdges() - numEdges;
+}
+
+int64_t GdfTail::bytesRead() const
+{
+    int64_t total = 0;
+    for(const TailFile &file : _files)
+        total += file.offset;
+    return total;
+}
+
+void GdfTail::findNewFiles()
+{
+    vector<string> fnames = FileIO::getFileNames(_path, ".gdf");
+    if(!_csvColumns.empty())
+    {
+        vector<string> csvFnames = FileIO::getFileNames(_path, ".csv");
+        fnames.insert(fnames.end(), csvFnames.begin(), csvFnames.end());
+    }
+    vector<pair<time_t,string>> newFiles;
+    for(const string &fname : fnames)
+    {
+        bool found = false;
+        for(const TailFile &file : _files)
+            found = found || file.fname == fname;
+        if(!found)
+            newFiles.push_back(make_pair(FileIO::getFileDate(fname), fname));
+    }
+    // Oldest files first
+    sort(newFiles.begin(), newFiles.end());
+    for(const auto &pair : newFiles)
+    {
+        cout << "Following new file: " << pair.second << endl;
+        this->addFile(pair.second);
+    }
+}
+
+void GdfTail::readFile(TailFile &file, DataGraph &g)
+{
+    struct stat st;
+    if(stat(file.fname.c_str(), &st) != 0)
+        return;
+    int64_t size = st.st_size;
+    if(size < file.offset)
+    {
+        // The edges we already read are assumed to still be at the start of
+        // the file.  The nodes are matched by name, so they aren't added twice.
+        cout << "File got smaller, so reading it again from the start: " << file.fname << endl;
+        int64_t numEdges = max(file.state.numEdges, file.state.numEdgesToSkip);
+        file.offset = 0;
+        file.state = FileIO::GdfState();
+        file.state.numEdgesToSkip = numEdges;
+    }
+    if(size == file.offset)
+        return;
+    if(file.isCsv && !file.state.isEdgeData)
+        FileIO::startCsvEdges(_csvColumns, g, file.state);
+
+    ifstream ifs(file.fname, ios::binary);
+    int64_t batchSize = BATCH_SIZE;
+    while(file.offset < size)
+    {
+        // Read the next batch
+        int64_t n = min(batchSize, size - file.offset);
+        _buf.resize(n);
+        ifs.seekg(file.offset);
+        ifs.read(_buf.data(), n);
+        n = ifs.gcount();
+        if(n <= 0)
+            break;
+
+        // Only use complete lines (the rest may still be getting written)
+        const char *lastBreak = (const char*)memrchr(_buf.data(), '\n', n);
+        if(lastBreak == 0)
+        {
+            if(file.offset + n >= size)
+                break;
+            // One line is longer than a batch
+            batchSize *= 2;
+            continue;
+        }
+        int64_t used = lastBreak + 1 - _buf.data();
+        const char *begin = _buf.data();
+        if(file.isCsv && _csvHeader && file.offset == 0)
+        {
+            // Skip the header line
+            begin = (const char*)memchr(begin, '\n', used) + 1;
+            file.state.lineNum++;
+        }
+        FileIO::parseGenericGDF(begin, _buf.data() + used, g, file.state);
+        file.offset += used;
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef GDF_TAIL_H
+#define GDF_TAIL_H
+
+#include "DataGraph.h"
+#include "FileIO.h"
+#include <stdint.h>
+#include <time.h>
+#include <string>
+#include <vector>
+
+/**
+ * Follows GDF files that are still being written to: either a single file,
+ * or a folder that new *.gdf files keep getting dropped into.  Each call to
+ * poll() only reads the bytes appended since the last call (up to the last
+ * complete line), and adds the new nodes and edges to the graph one batch at
+ * a time.  Files in a folder are read in the order of their modification dates.
+ * CSV files of edges (*.csv) are followed too, if it's given their columns.
+ */
+class GdfTail
+{
+public:
+    /** Most bytes parsed and added to the graph at once */
+    static constexpr int64_t BATCH_SIZE = 16 << 20;
+
+    /**
+     * Follows the given GDF file, or all the GDF files in the given folder.
+     * @param path  File or folder to follow.
+     * @param csvColumns  Columns of the CSV files, as on a GDF "edgedef>"
+     * line (see FileIO::startCsvEdges()), or empty to only follow GDF files.
+     * @param csvHeader  True if the first line of each CSV file is a header.
+     */
+    GdfTail(const std::string &path, const std::string &csvColumns = "", bool csvHeader = false);
+    /**
+     * Looks for new files and new lines in the files we're following, and
+     * adds them to the graph.
+     * @return The number of edges added.
+     */
+    int poll(DataGraph &g);
+    /** Number of files found so far */
+    int numFiles() const { return _files.size(); }
+    /** Total number of bytes read from all the files */
+    int64_t bytesRead() const;
+
+private:
+    /** A file we're following, and how far we've read */
+    struct TailFile
+    {
+        std::string fname;
+        bool isCsv;
+        int64_t offset;
+        FileIO::GdfState state;
+    };
+
+    /** Starts following the given file */
+    void addFile(const std::string &fname);
+    /** Adds any new files in the folder */
+    void findNewFiles();
+    /** Reads anything appended to the file */
+    void readFile(TailFile &file, DataGraph &g);
+
+    std::string _path;
+    bool _isFolder;
+    std::string _csvColumns;
+    bool _csvHeader;
+    std::vector<TailFile> _files;
+    std::vector<char> _buf;
+};
+
+#endif
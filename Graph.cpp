@@ -1,4 +1,5 @@
 #include "Graph.h"
+#include "GraphStats.h"
 #include "Node.h"
 #include <algorithm>
 #include <iostream>
@@ -9,7 +10,8 @@ using namespace std;
 
 Graph::Graph(int windowDuration)
 {
-    _edgesReady = false;
+    // No edges yet, so they're all in order
+    _edgesReady = true;
     _windowDuration = windowDuration;
     _windowStart = 0;
     _windowEnd = 0;
@@ -21,6 +23,7 @@ Graph::Graph(int windowDuration)
 
 void Graph::addNode(int v)
 {
+    this->checkNotFrozen();
     if(v >= _nodes.size())
         _nodes.resize(v+1);
 }
@@ -37,18 +40,26 @@ void Graph::addEdge(int u, int v, time_t dateTime)
         //throw "No self loops allowed";
     if(u < 0 || v < 0)
         throw "Vertices must be >= 0";
+    this->checkNotFrozen();
     
     // Calculate what the min number of nodes should be
     int min_n = std::max(u,v) + 1;
     // Resize as necessary
     if(_nodes.size() < min_n)
         _nodes.resize(min_n);
-    
-    // Add to the sorted map, based on time
-    _timeEdgeMap[dateTime].push_back(Edge(_numEdges,u,v,dateTime));
+
+    if(_edgesReady && (_edges.empty() || dateTime >= _edges.time(_edges.size()-1)))
+    {
+        // Still in chronological order, so nothing else needs to change
+        this->appendOrderedEdge(_numEdges, u, v, dateTime);
+    }
+    else
+    {
+        // Out of order, so it has to wait to be merged in
+        _pendingEdges.push_back(Edge(_numEdges,u,v,dateTime));
+        _edgesReady = false;
+    }
     _numEdges++;
-    
-    _edgesReady = false;
 
     // Update window start/end if necessary
     if(dateTime > _windowEnd)
@@ -56,17 +67,19 @@ void Graph::addEdge(int u, int v, time_t dateTime)
 	_windowEnd = dateTime;
 	_windowStart = _windowEnd - _windowDuration;
     }
-    
-    // Index of new edge
-    //int edge_index = _edges.size();
-    // Create edge
-    //_edges.push_back(Edge(edge_index,u,v));
-    
-    // Add to nodes
-    /*_nodes[u].edges().push_back(edge_index);
-    _nodes[v].edges().push_back(edge_index);
-    _nodes[u].outEdges().push_back(edge_index);
-    _nodes[v].inEdges().push_back(edge_index);*/
+}
+
+void Graph::appendOrderedEdge(int insertIndex, int u, int v, time_t dateTime) const
+{
+    int e = _edges.size();
+    _edges.add(u, v, dateTime);
+    _insertOrder.push_back(insertIndex);
+    _nodes[u].edges().push_back(e);
+    _nodes[v].edges().push_back(e);
+    _nodes[u].outEdges().push_back(e);
+    _nodes[v].inEdges().push_back(e);
+    if(_nodeEdgesReady)
+        _nodeEdges[u][v].push_back(e);
 }
 
 void Graph::copyEdge(int edgeIndex, const Graph &g)
@@ -77,30 +90,44 @@ void Graph::copyEdge(int edgeIndex, const Graph &g)
 
 bool Graph::hasEdge(int u, int v) const
 {
-    if(!_edgesReady)
-        this->updateOrderedEdges();
-    
-    return _nodeEdges.find(u) != _nodeEdges.end() && _nodeEdges[u].find(v) != _nodeEdges[u].end();
+    this->buildPairEdges();
+    auto uIter = _nodeEdges.find(u);
+    return uIter != _nodeEdges.end() && uIter->second.find(v) != uIter->second.end();
 }
 
 const vector<int> &Graph::getEdgeIndexes(int u, int v) const
 {
-    if(!_edgesReady)
-        this->updateOrderedEdges();
-    
-    if(!hasEdge(u,v))
-        throw "There are no edges between the vertices selected.";
-    
-    return _nodeEdges[u][v];
+    this->buildPairEdges();
+    auto uIter = _nodeEdges.find(u);
+    if(uIter != _nodeEdges.end())
+    {
+        auto vIter = uIter->second.find(v);
+        if(vIter != uIter->second.end())
+            return vIter->second;
+    }
+    throw "There are no edges between the vertices selected.";
+}
+
+const vector<int> *Graph::pairEdges(int u, int v) const
+{
+    static const vector<int> noEdges;
+    if(!_edgesReady || !_nodeEdgesReady)
+        return NULL;
+    auto uIter = _nodeEdges.find(u);
+    if(uIter == _nodeEdges.end())
+        return &noEdges;
+    auto vIter = uIter->second.find(v);
+    if(vIter == uIter->second.end())
+        return &noEdges;
+    return &vIter->second;
 }
 
-const vector<Edge> &Graph::edges() const
+void Graph::buildPairEdges() const
 {
     if(!_edgesReady)
-    {
         this->updateOrderedEdges();
-    }
-    return _edges;
+    if(!_nodeEdgesReady)
+        this->updateNodeEdges();
 }
 
 void Graph::disp() const
@@ -122,8 +149,7 @@ void Graph::disp(int edgeIndex) const
     if(!_edgesReady)
         this->updateOrderedEdges();
     
-    const Edge &edge = _edges[edgeIndex];
-    cout << "[" << edgeIndex << "] " << edge.source() << " -> " << edge.dest() << endl;
+    cout << "[" << edgeIndex << "] " << _edges.source(edgeIndex) << " -> " << _edges.dest(edgeIndex) << endl;
 }
 
 void Graph::dispDateTimeRange() const
@@ -145,63 +171,154 @@ void Graph::dispDateTimeRange() const
 
 void Graph::updateOrderedEdges() const
 {
-//    cout << "Sorting edges chronologically." << endl;
-    
-    int n = _nodes.size();
-    
-    // Clear old edges
-    _edges.clear();
-    for(Node &node : _nodes)
+    // Edges that arrived at the same time stay in the order they were added
+    stable_sort(_pendingEdges.begin(), _pendingEdges.end(), 
+                [](const Edge &a, const Edge &b) { return a.time() < b.time(); });
+
+    // Only the edges after the earliest late one need to move
+    int m = _edges.size();
+    int start = m;
+    if(!_pendingEdges.empty())
+        start = _edges.firstAt(_pendingEdges.front().time() + 1);  // (the first edge after it)
+    _reorderStart = start;
+
+    // Take the moved edges off the ends of their nodes' lists (last one first)
+    vector<Edge> moved;
+    moved.reserve(m - start);
+    for(int e=start; e<m; e++)
+        moved.push_back(Edge(_insertOrder[e], _edges.source(e), _edges.dest(e), _edges.time(e)));
+    for(int e=m-1; e>=start; e--)
     {
-        node.edges().clear();
-        node.outEdges().clear();
-        node.inEdges().clear();
+        Node &source = _nodes[_edges.source(e)];
+        Node &dest = _nodes[_edges.dest(e)];
+        source.edges().pop_back();
+        dest.edges().pop_back();
+        source.outEdges().pop_back();
+        dest.inEdges().pop_back();
     }
-    
-    // Build edge list in chronological order
-    int edge_index = 0;
-    for(auto &pair : _timeEdgeMap)
+    _edges.truncate(start);
+    _insertOrder.resize(start);
+
+    // Merge them back with the late edges (the ones added first go first when the times are equal)
+    int i = 0, j = 0;
+    while(i < moved.size() || j < _pendingEdges.size())
     {
-        time_t dateTime = pair.first;
-        const vector<Edge> &edges = _timeEdgeMap.find(dateTime)->second;
-        for(const Edge &edge : edges)
-        {
-            // Create new edge now that we know the time index
-            Edge newEdge(edge_index, edge.source(), edge.dest(), edge.time());
-            _edges.push_back(newEdge);
-            _edgeTimes.push_back(dateTime);
-            
-            int u = edge.source(), v = edge.dest();
-            
-            _nodes[u].edges().push_back(edge_index);
-            _nodes[v].edges().push_back(edge_index);
-            _nodes[u].outEdges().push_back(edge_index);
-            _nodes[v].inEdges().push_back(edge_index);
-            
-            edge_index++;
-        }
+        bool useMoved = j >= _pendingEdges.size() || (i < moved.size() && moved[i].time() <= _pendingEdges[j].time());
+        const Edge &edge = useMoved ? moved[i++] : _pendingEdges[j++];
+        this->appendOrderedEdge(edge.index(), edge.source(), edge.dest(), edge.time());
     }
+    _pendingEdges.clear();
     
+    // The nodeEdges map is only built if it's needed
+    if(start < m)
+        _nodeEdgesReady = false;
+    
+    // Make sure we flag the edges as ready now, so we don't redo this every time
+    _edgesReady = true;
+}
+
+void Graph::updateNodeEdges() const
+{
     // Setup nodeEdges map    
+    int n = _nodes.size();
     this->_nodeEdges.clear();
     for(int u=0; u<n; u++)
     {
         const Node &node = _nodes[u];
         for(int e : node.outEdges())            
         {
-            const Edge &edge = _edges[e];
-            int v = edge.dest();
+            int v = _edges.dest(e);
             _nodeEdges[u][v].push_back(e);
         }
     }
-    
-    // Make sure we flag the edges as ready now, so we don't redo this every time
+    _nodeEdgesReady = true;
+}
+
+void Graph::setOrderedEdges(int n, int m, const int32_t *sources, const int32_t *dests, const int64_t *times,
+                            const int64_t *outOffsets, const int32_t *outEdges,
+                            const int64_t *inOffsets, const int32_t *inEdges)
+{
+    this->checkNotFrozen();
+    _edges.assign(m, sources, dests, times);
+    _insertOrder.resize(m);
+    for(int e=0; e<m; e++)
+        _insertOrder[e] = e;
+
+    _nodes.clear();
+    _nodes.resize(n);
+    for(int v=0; v<n; v++)
+    {
+        Node &node = _nodes[v];
+        node.outEdges().assign(outEdges + outOffsets[v], outEdges + outOffsets[v+1]);
+        node.inEdges().assign(inEdges + inOffsets[v], inEdges + inOffsets[v+1]);
+        // All edges are both lists merged (self loops are listed twice)
+        node.edges().resize(node.outEdges().size() + node.inEdges().size());
+        merge(node.outEdges().begin(), node.outEdges().end(), node.inEdges().begin(), node.inEdges().end(), node.edges().begin());
+    }
+
+    _numEdges = m;
+    if(m > 0 && times[m-1] > _windowEnd)
+    {
+        _windowEnd = times[m-1];
+        _windowStart = _windowEnd - _windowDuration;
+    }
+
+    _pendingEdges.clear();
+    _reorderStart = 0;
+    _firstEdge = 0;
+    _nodeEdgesReady = false;
     _edgesReady = true;
 }
 
+void Graph::setStats(const GraphStats &stats)
+{
+    this->checkNotFrozen();
+    _stats = make_shared<GraphStats>(stats);
+}
+
+void Graph::renumberNodes(const vector<int> &order)
+{
+    this->checkNotFrozen();
+    if(!_edgesReady)
+        this->updateOrderedEdges();
+
+    int n = _nodes.size();
+    if(order.size() != n)
+        throw "The new node order has to list every node once.";
+    vector<int> newIds(n, -1);
+    for(int i=0; i<n; i++)
+    {
+        int v = order[i];
+        if(v < 0 || v >= n || newIds[v] >= 0)
+            throw "The new node order has to list every node once.";
+        newIds[v] = i;
+    }
+
+    // The adjacency lists are lists of edges, so they stay the same
+    reorderNodeValues(_nodes, order);
+    _edges.renumberNodes(newIds);
+    _nodeEdges.clear();
+    _nodeEdgesReady = false;
+}
+
+void Graph::freeze()
+{
+    // (subclasses put their own per-edge data in order along with the edges)
+    this->buildPairEdges();
+    _isFrozen = true;
+}
+
+int Graph::firstEdgeAt(time_t t, int from) const
+{
+    if(!_edgesReady)
+        this->updateOrderedEdges();
+    
+    return _edges.firstAt(t, from);
+}
+
 time_t Graph::windowStart() const
 {
-    time_t dataStart = _edgeTimes.front();
+    time_t dataStart = _edges.time(0);
     if(dataStart > _windowStart)
 	return dataStart;
     return _windowStart;
@@ -209,14 +326,100 @@ time_t Graph::windowStart() const
 
 time_t Graph::windowEnd() const
 {
-    time_t dataEnd = _edgeTimes.back();
+    time_t dataEnd = _edges.time(_edges.size()-1);
     if(dataEnd < _windowEnd)
 	return dataEnd;
     return _windowEnd;
 }
 
+int Graph::evictOldEdges()
+{
+    if(_windowDuration == 0)
+        return 0;
+    return this->evictEdgesBefore(_windowStart);
+}
+
+int Graph::evictEdgesBefore(time_t start)
+{
+    this->checkNotFrozen();
+    if(!_edgesReady)
+        this->updateOrderedEdges();
+
+    // Skip the edges that are too old (late edges may have been merged in
+    // before the old first edge, so start over)
+    _firstEdge = _edges.firstAt(start);
+
+    // Only remove them once they're at least half the edges, so each edge is
+    // moved a constant number of times (on average)
+    int count = _firstEdge;
+    int m = _edges.size();
+    if(count == 0 || 2*count < m)
+        return 0;
+    this->removeOldestEdges(count);
+    return count;
+}
+
+void Graph::removeOldestEdges(int count)
+{
+    int m = _edges.size();
+
+    // The old edges are at the start of their nodes' lists, and only the
+    // lists of the nodes that still have edges need to be renumbered, so
+    // nodes without any edges aren't touched
+    const EdgeNodes *edgeNodes = _edges.nodes();
+    for(int e=0; e<count; e++)
+    {
+        for(int v : {edgeNodes[e].source, edgeNodes[e].dest})
+        {
+            Node &node = _nodes[v];
+            removeOldEdges(node.edges(), count);
+            removeOldEdges(node.outEdges(), count);
+            removeOldEdges(node.inEdges(), count);
+        }
+    }
+    for(int e=count; e<m; e++)
+    {
+        for(int v : {edgeNodes[e].source, edgeNodes[e].dest})
+        {
+            // (each node's lists are renumbered at its first edge)
+            Node &node = _nodes[v];
+            if(node.edges().front() != e)
+                continue;
+            for(vector<int> *list : {&node.edges(), &node.outEdges(), &node.inEdges()})
+            {
+                for(int &i : *list)
+                    i -= count;
+            }
+        }
+    }
+
+    _edges.removeFirst(count);
+    // Subclasses put their own data in chronological order, so that's the insertion order now too
+    _insertOrder.resize(m - count);
+    for(int e=0; e<m-count; e++)
+        _insertOrder[e] = e;
+
+    _numEdges = m - count;
+    _numRemovedEdges += count;
+    _firstEdge = 0;
+    _reorderStart = 0;
+    _nodeEdges.clear();
+    _nodeEdgesReady = false;
+}
+
+void Graph::removeOldEdges(vector<int> &edgeIndexes, int count)
+{
+    if(edgeIndexes.empty() || edgeIndexes.front() >= count)
+        return;
+    edgeIndexes.erase(edgeIndexes.begin(), lower_bound(edgeIndexes.begin(), edgeIndexes.end(), count));
+    // Give back the memory once most of it isn't used
+    if(edgeIndexes.capacity() > 2*edgeIndexes.size())
+        edgeIndexes.shrink_to_fit();
+}
+
 void Graph::setWindowDuration(int duration)
 {
+    this->checkNotFrozen();
     if(duration == _windowDuration)
 	return;
 
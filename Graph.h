@@ -8,12 +8,18 @@
 #ifndef GRAPH_H
 #define	GRAPH_H
 
+#include <stdint.h>
+#include <memory>
 #include <vector>
 #include <map>
 #include <unordered_map>
+#include <utility>
 #include <time.h>
 #include "Node.h"
 #include "Edge.h"
+#include "EdgeList.h"
+
+class GraphStats;
 
 /**
  * Our standard, directed graph, where edges are listed in the order they
@@ -30,7 +36,10 @@ public:
     virtual void addNode(int v);
     /** Adds edge, and resizes the nodes, as necessary */
     virtual void addEdge(int u, int v);
-    /** Adds edge, and resizes the nodes, as necessary */
+    /** Adds edge, and resizes the nodes, as necessary.
+     * Edges that aren't earlier than the latest one so far are appended to the
+     * edge list and adjacency lists right away.  Earlier ones are kept in a 
+     * reorder buffer, and merged in the next time the edges are needed. */
     virtual void addEdge(int u, int v, time_t dateTime);
     /** Copies the given edge from another graph (useful for making sure metadata is consistent */
     virtual void copyEdge(int edgeIndex, const Graph &g);
@@ -38,12 +47,26 @@ public:
     virtual bool hasEdge(int u, int v) const;
     /** Returns a list of all edges between the two points (directed) */    
     virtual const std::vector<int> &getEdgeIndexes(int u, int v) const;
+    /** Chronological list of the edges from u to v (which may be empty), or
+     * NULL if the map of edges between each pair of nodes isn't built. */
+    const std::vector<int> *pairEdges(int u, int v) const;
+    /** Builds the map of edges between each pair of nodes, if it isn't already.
+     * New edges are added to it, but removing or reordering edges clears it. */
+    void buildPairEdges() const;
     /** Creates a subgraph from the given set of nodes */
     //virtual Graph createSubGraph(const std::vector<int> &nodes);
     /** List of all nodes in the graph */
     virtual const std::vector<Node> &nodes() const { return _nodes; }
-    /** Ordered list of all edges (sorted by order of occurrence) */
-    virtual const std::vector<Edge> &edges() const;
+    /** Ordered list of all edges (sorted by order of occurrence).  Inline,
+     * since the criteria call it for nearly every edge they test.  The search
+     * itself gets the list once, up front, so its loops don't test whether
+     * late edges need to be merged in (which they never do once it's frozen). */
+    const EdgeList &edges() const
+    {
+        if(!_edgesReady)
+            this->updateOrderedEdges();
+        return _edges;
+    }
     /** Gets the number of nodes (without having to sort anything) */
     virtual int numNodes() const { return _nodes.size(); }
     /** Gets the number of edges (without having to sort anything) */
@@ -62,21 +85,147 @@ public:
     time_t windowStart() const;// { return _windowStart; }
     /** End time of our current window */
     time_t windowEnd() const;// { return _windowEnd; }
+    /**
+     * Drops the edges that are older than the start of the window, so a graph
+     * that keeps getting new edges only uses memory for the ones in its window.
+     * The old edges are first just skipped (see firstEdge()), and are only
+     * removed once they make up half of the edges, at which point the rest of
+     * the edges (and all per-edge data) get renumbered to start at 0.
+     * Does nothing if there's no window.  Edge indexes from before the call
+     * (e.g., in a GraphMatch) may no longer be valid afterwards.  Only the
+     * lists of the nodes with edges are changed, so the time it takes is
+     * proportional to the edges, not to every node ever added.
+     * @return The number of edges that were removed.
+     */
+    int evictOldEdges();
+    /** Same as evictOldEdges(), but drops the edges older than the given time
+     * (e.g., ones that have already been handed off somewhere else). */
+    int evictEdgesBefore(time_t start);
+    /** First edge (in chronological order) that's still in the window after
+     * evictOldEdges().  Edges before it are waiting to be removed. */
+    int firstEdge() const { return _firstEdge; }
+    /** First edge (in chronological order) at or after time t, or numEdges()
+     * if there isn't one.  Since the edges (and every node's lists of them) are
+     * in order, this turns a time limit into an edge index limit.  Searching
+     * from an edge before t is faster when it's close to t. */
+    int firstEdgeAt(time_t t, int from=0) const;
+    /** Total number of edges removed by evictOldEdges() so far.  An edge's
+     * index plus this stays the same when older edges are removed. */
+    int64_t numRemovedEdges() const { return _numRemovedEdges; }
+    /** Statistics about the graph as of when they were computed (usually when
+     * it was loaded), or NULL if they haven't been.  A graph made by
+     * GraphFilter has the statistics of the graph it was filtered from. */
+    const GraphStats *stats() const { return _stats.get(); }
+    /** Stores the statistics computed for the graph (see GraphStats) */
+    void setStats(const GraphStats &stats);
+    /**
+     * Gives the nodes new indexes, so the ones that are used together can be
+     * put close together in memory (see NodeOrder).  Everything about a node
+     * (its name, attributes, etc.) moves with it; the edges keep their order.
+     * Node indexes from before the call are no longer valid afterwards.
+     * @param order  Every node, in its new order (node order[i] becomes node i).
+     */
+    virtual void renumberNodes(const std::vector<int> &order);
+    /**
+     * Makes the graph read-only, so any number of threads can search it at
+     * the same time.  Everything the const methods would otherwise do lazily
+     * the first time it's needed (merging late edges in, and building the
+     * map of edges between each pair of nodes, along with subclasses'
+     * per-edge data) is done now, so afterwards they only read.  Adding or
+     * removing edges or nodes throws from then on (copies of the graph are
+     * frozen too).  The map of edges between each pair of nodes takes memory
+     * for every edge, so only freeze graphs that are shared between threads.
+     * The threads can share a criteria too, since anything it precomputes
+     * goes in a copy owned by each search (see MatchCriteria::prepare()).
+     */
+    void freeze();
+    /** True if freeze() was called, and the graph can't be changed */
+    bool isFrozen() const { return _isFrozen; }
 protected:    
+    /** Merges any edges in the reorder buffer into the chronological edge list. */
     virtual void updateOrderedEdges() const;
+    /** For each edge (in chronological order), the order in which it was added.
+     * Lets subclasses sort their own per-edge data to match. */
+    const std::vector<int> &insertionOrder() const { return _insertOrder; }
+    /** First edge (in chronological order) that was moved or added by the last 
+     * updateOrderedEdges().  Per-edge data for the edges before it is unchanged,
+     * so subclasses only need to redo their own data from here on. */
+    int reorderStart() const { return _reorderStart; }
+    /**
+     * Replaces the graph with edges that are already in chronological order,
+     * along with their adjacency lists in compressed (CSR) form, without any
+     * sorting.  Used when loading snapshots.
+     * @param n  Number of nodes.
+     * @param m  Number of edges.
+     * @param sources  Source node of each edge.
+     * @param dests  Destination node of each edge.
+     * @param times  Time of each edge.
+     * @param outOffsets  n+1 offsets into outEdges where each node's out edges start.
+     * @param outEdges  Out edges of every node, in chronological order.
+     * @param inOffsets  n+1 offsets into inEdges where each node's in edges start.
+     * @param inEdges  In edges of every node, in chronological order.
+     */
+    void setOrderedEdges(int n, int m, const int32_t *sources, const int32_t *dests, const int64_t *times,
+                         const int64_t *outOffsets, const int32_t *outEdges,
+                         const int64_t *inOffsets, const int32_t *inEdges);
+    /** Removes the first count edges (in chronological order) from the graph,
+     * and shifts the indexes of the rest down.  Subclasses remove their own
+     * per-edge data for them too.  Only called when there are no edges in the
+     * reorder buffer. */
+    virtual void removeOldestEdges(int count);
+    /** Throws if the graph is frozen (see freeze()).  Called before changing anything. */
+    void checkNotFrozen() const
+    {
+        if(_isFrozen)
+            throw "The graph is frozen, so it can't be changed.";
+    }
+    /** Removes the first count edges from a chronological list of edge
+     * indexes (for removeOldestEdges()), without renumbering the rest, and
+     * frees the memory once most of the list is gone. */
+    static void removeOldEdges(std::vector<int> &edgeIndexes, int count);
+    /** Puts a list of values for each node in the order given to renumberNodes().
+     * (Lists that don't have every node yet are filled out with default values.) */
+    template<typename T>
+    static void reorderNodeValues(std::vector<T> &values, const std::vector<int> &order)
+    {
+        if(values.size() < order.size())
+            values.resize(order.size());
+        std::vector<T> reordered;
+        reordered.reserve(values.size());
+        for(int v : order)
+            reordered.push_back(std::move(values[v]));
+        for(size_t v=order.size(); v<values.size(); v++)
+            reordered.push_back(std::move(values[v]));
+        values.swap(reordered);
+    }
     // Flag to determine if we've built our complete list of edges yet
     mutable bool _edgesReady;    
     
 private:
+    /** Builds the map of edges between each pair of nodes */
+    void updateNodeEdges() const;
+    /** Adds an edge to the end of the chronological edge list and adjacency lists */
+    void appendOrderedEdge(int insertIndex, int u, int v, time_t dateTime) const;
+
     int _numEdges = 0;
     mutable std::vector<Node> _nodes;
     int _windowDuration;
     time_t _windowStart, _windowEnd;
-    // Ordered map, by date/time
-    std::map<time_t,std::vector<Edge>> _timeEdgeMap;
-    mutable std::vector<time_t> _edgeTimes;
-    mutable std::vector<Edge> _edges;
+    // All edges (except those in the reorder buffer) in chronological order
+    mutable EdgeList _edges;
+    mutable std::vector<int> _insertOrder;
+    // Edges that arrived earlier than the latest edge, waiting to be merged in
+    // (indexed by the order they were added in)
+    mutable std::vector<Edge> _pendingEdges;
+    mutable int _reorderStart = 0;
+    // Edges before this one are older than the window (and will be removed)
+    int _firstEdge = 0;
+    int64_t _numRemovedEdges = 0;
+    // (shared by copies of the graph)
+    std::shared_ptr<const GraphStats> _stats;
     mutable std::unordered_map<int,std::unordered_map<int,std::vector<int>>> _nodeEdges;
+    mutable bool _nodeEdgesReady = false;
+    bool _isFrozen = false;
 };
 
 #endif	/* GRAPH_H */
@@ -1,6 +1,11 @@
 #include "GraphFilter.h"
 #include "CertGraph.h"
+#include "ColumnScan.h"
+#include <climits>
+#include <cmath>
 #include <iostream>
+#include <memory>
+#include <typeinfo>
 #include <unordered_set>
 #include <string>
 
@@ -9,6 +14,9 @@ using namespace std;
 void GraphFilter::filter(const Graph& g, const Graph& h, const MatchCriteria& criteria, Graph &g2)
 {
     cout << "Filtering graph" << endl;
+    // Use the criteria prepared for g and h, if there is one
+    unique_ptr<MatchCriteria> prepared = criteria.prepare(g, h);
+    const MatchCriteria &matchCriteria = prepared ? *prepared : criteria;
     
     int g_n = g.numNodes();
     int g_m = g.numEdges();
@@ -26,7 +34,7 @@ void GraphFilter::filter(const Graph& g, const Graph& h, const MatchCriteria& cr
             //cout << "Checking against " << h_i << endl;
             // If it matches at least one, we can go ahead and add it, and
             // stop the search
-            if(criteria.isEdgeMatch(g, g_i, h, h_i))
+            if(matchCriteria.isEdgeMatch(g, g_i, h, h_i))
             {
                 //cout << "Match found" << endl;
                 g2.copyEdge(g_i, g);
@@ -34,11 +42,18 @@ void GraphFilter::filter(const Graph& g, const Graph& h, const MatchCriteria& cr
             }
         }        
     }
+
+    // Every edge that can match is kept, so the catalog's counts of them still hold
+    if(g.stats() != NULL)
+        g2.setStats(*g.stats());
 }
 
 void GraphFilter::filter(const CertGraph &g, const CertGraph &h, const MatchCriteria &criteria, CertGraph &g2)
 {
     cout << "Filtering graph" << endl;
+    // Use the criteria prepared for g and h, if there is one
+    unique_ptr<MatchCriteria> prepared = criteria.prepare(g, h);
+    const MatchCriteria &matchCriteria = prepared ? *prepared : criteria;
     
     int g_n = g.numNodes();
     int g_m = g.numEdges();
@@ -62,7 +77,7 @@ void GraphFilter::filter(const CertGraph &g, const CertGraph &h, const MatchCrit
     if(hasDegRes)
     {
 	bool useAllEdges = false;
-	unordered_set<string> edgeTypes;
+	vector<bool> edgeTypes(TypeDictionary::size(), false);
 	// Find edge types used in node restrictions
 	for(int h_v=0; h_v<h_n; h_v++)
 	{
@@ -71,24 +86,24 @@ void GraphFilter::filter(const CertGraph &g, const CertGraph &h, const MatchCrit
 		const vector<DegRestriction> &restricts = h.getDegRestrictions(h_v);
 		for(const DegRestriction &restrict : restricts)
 		{
-		    edgeTypes.insert(restrict.edgeType());
+		    edgeTypes[restrict.edgeTypeId()] = true;
 		}
 	    }
 	}
 	// Add all other used edge types as well
 	for(int h_e=0; h_e<h_m; h_e++)
 	{
-	    const string &type = h.getEdgeType(h_e);
-	    if(type.empty())        
+	    int type = h.getEdgeTypeId(h_e);
+	    if(type == 0)        
 		useAllEdges = true;
 	    else
-		edgeTypes.insert(type);
+		edgeTypes[type] = true;
 	}        
 	// Try each edge
 	for(int g_i=0; g_i<g_m; g_i++)
 	{	
-	    const string &type = g.getEdgeType(g_i);
-	    if(useAllEdges || edgeTypes.find(type) != edgeTypes.end())
+	    int type = g.getEdgeTypeId(g_i);
+	    if(useAllEdges || edgeTypes[type])
 	    {
 		g2.copyEdge(g_i, g);
 	    }
@@ -105,7 +120,7 @@ void GraphFilter::filter(const CertGraph &g, const CertGraph &h, const MatchCrit
 		//cout << "Checking against " << h_i << endl;
 		// If it matches at least one, we can go ahead and add it, and
 		// stop the search
-		if(criteria.isEdgeMatch(g, g_i, h, h_i))
+		if(matchCriteria.isEdgeMatch(g, g_i, h, h_i))
 		{
 		    //cout << "Match found" << endl;
 		    g2.copyEdge(g_i, g);
@@ -114,11 +129,15 @@ void GraphFilter::filter(const CertGraph &g, const CertGraph &h, const MatchCrit
 	    }       
 	}
     }
+
+    // Every edge that can match is kept, so the catalog's counts of them still hold
+    if(g.stats() != NULL)
+        g2.setStats(*g.stats());
 }
 
 void GraphFilter::filter(const CertGraph &g, time_t start, time_t end, CertGraph &g2)
 {
-    const vector<Edge> &edges = g.edges();
+    const EdgeList &edges = g.edges();
     // Try all edges
     for(const Edge &edge : edges)
     {
@@ -130,3 +149,159 @@ void GraphFilter::filter(const CertGraph &g, time_t start, time_t end, CertGraph
         }       
     }
 }
+
+void GraphFilter::filter(const DataGraph &g, const DataGraph &h, const MatchCriteria_DataGraph &criteria, DataGraph &g2)
+{
+    // Derived criteria may add their own tests, so they get the edge at a time filter
+    if(typeid(criteria) != typeid(MatchCriteria_DataGraph))
+    {
+        GraphFilter::filter((const Graph&)g, (const Graph&)h, (const MatchCriteria&)criteria, (Graph&)g2);
+        return;
+    }
+
+    cout << "Filtering graph (" << ColumnScan::implementation() << " column scan)" << endl;
+
+    int g_n = g.numNodes();
+    int g_m = g.numEdges();
+
+    int h_n = h.numNodes();
+    int h_m = h.numEdges();
+
+    const AttributeColumns &gNodes = g.nodeColumns();
+    const AttributeColumns &hNodes = h.nodeColumns();
+    const AttributeColumns &gEdgeCols = g.edgeColumns();
+    const AttributeColumns &hEdgeCols = h.edgeColumns();
+    const EdgeList &gEdges = g.edges();
+    const EdgeList &hEdges = h.edges();
+
+    // Which graph nodes match each query node
+    int nodeWords = (g_n + 63) / 64;
+    vector<vector<uint64_t>> nodeBits(h_n);
+    for(int h_v=0; h_v<h_n; h_v++)
+    {
+        nodeBits[h_v].assign(nodeWords, ~0ULL);
+        GraphFilter::scanColumns(gNodes, 0, g_n, hNodes, h_v, nodeBits[h_v].data());
+    }
+
+    // Test the edges a block at a time
+    const int BLOCK_SIZE = 4096;
+    const int BLOCK_WORDS = BLOCK_SIZE / 64;
+    uint64_t bits[BLOCK_WORDS];
+    uint64_t survivors[BLOCK_WORDS];
+    time_t start = g.windowStart(), end = g.windowEnd();
+    for(int first=0; first<g_m; first+=BLOCK_SIZE)
+    {
+        int n = min(BLOCK_SIZE, g_m - first);
+        int words = (n + 63) / 64;
+        for(int w=0; w<words; w++)
+            survivors[w] = 0;
+
+        for(int h_i=0; h_i<h_m; h_i++)
+        {
+            for(int w=0; w<words; w++)
+                bits[w] = ~0ULL;
+            if(n % 64 != 0)
+                bits[words-1] = (1ULL << (n % 64)) - 1;
+            GraphFilter::scanColumns(gEdgeCols, first, n, hEdgeCols, h_i, bits);
+
+            // Remaining tests are the time window and the two end nodes
+            const vector<uint64_t> &sourceBits = nodeBits[hEdges[h_i].source()];
+            const vector<uint64_t> &destBits = nodeBits[hEdges[h_i].dest()];
+            for(int w=0; w<words; w++)
+            {
+                uint64_t word = bits[w] & ~survivors[w];
+                while(word)
+                {
+                    int b = __builtin_ctzll(word);
+                    word &= word - 1;
+                    const Edge &edge = gEdges[first + w*64 + b];
+                    int u = edge.source(), v = edge.dest();
+                    if(edge.time() < start || edge.time() > end ||
+                       !(sourceBits[u >> 6] & (1ULL << (u & 63))) ||
+                       !(destBits[v >> 6] & (1ULL << (v & 63))))
+                    {
+                        bits[w] &= ~(1ULL << b);
+                    }
+                }
+                survivors[w] |= bits[w];
+            }
+        }
+
+        // Copy the edges that matched at least one query edge, in order
+        for(int w=0; w<words; w++)
+        {
+            uint64_t word = survivors[w];
+            while(word)
+            {
+                int b = __builtin_ctzll(word);
+                word &= word - 1;
+                g2.copyEdge(first + w*64 + b, g);
+            }
+        }
+    }
+
+    // Every edge that can match is kept, so the catalog's counts of them still hold
+    if(g.stats() != NULL)
+        g2.setStats(*g.stats());
+}
+
+void GraphFilter::scanColumns(const AttributeColumns &g, int start, int n, const AttributeColumns &h, int hRow, uint64_t *bits)
+{
+    if(g.numFloatColumns() != h.numFloatColumns() ||
+       g.numIntColumns() != h.numIntColumns() ||
+       g.numStringColumns() != h.numStringColumns())
+    {
+        throw "Can't compare attributes. Number of attributes of each type don't match!";
+    }
+
+    for(int k=0; k<g.numFloatColumns(); k++)
+    {
+        const FloatRestrictions &r = h.floatRestriction(k, hRow);
+        const float *values = g.floatColumn(k) + start;
+        if(r.any())
+            continue;
+        if(r.exact())
+            ColumnScan::floatEquals(values, n, h.floatColumn(k)[hRow], bits);
+        else
+        {
+            float lo = r.hasMin() ? r.min() : -INFINITY;
+            float hi = r.hasMax() ? r.max() : INFINITY;
+            ColumnScan::floatRange(values, n, lo, hi, bits);
+        }
+    }
+
+    for(int k=0; k<g.numIntColumns(); k++)
+    {
+        const IntRestrictions &r = h.intRestriction(k, hRow);
+        const int *values = g.intColumn(k) + start;
+        if(r.any())
+            continue;
+        if(r.exact())
+        {
+            int x = h.intColumn(k)[hRow];
+            ColumnScan::intRange(values, n, x, x, bits);
+        }
+        else
+        {
+            int lo = r.hasMin() ? r.min() : INT_MIN;
+            int hi = r.hasMax() ? r.max() : INT_MAX;
+            ColumnScan::intRange(values, n, lo, hi, bits);
+        }
+    }
+
+    for(int k=0; k<g.numStringColumns(); k++)
+    {
+        const StringRestrictions &r = h.stringRestriction(k, hRow);
+        if(r.any() || !r.exact())
+            continue;
+        // Strings are compared by their code in g's dictionary
+        int code = g.findStringCode(k, h.stringAt(k, hRow));
+        if(code < 0)
+        {
+            for(int w=0; w<(n + 63) / 64; w++)
+                bits[w] = 0;
+            return;
+        }
+        ColumnScan::intRange(g.stringColumn(k) + start, n, code, code, bits);
+    }
+}
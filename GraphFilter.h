@@ -9,12 +9,18 @@
 #define	GRAPHFILTER_H
 
 #include "Graph.h"
+#include "AttributeColumns.h"
 #include "CertGraph.h"
+#include "DataGraph.h"
 #include "MatchCriteria.h"
+#include "MatchCriteria_DataGraph.h"
+#include <stdint.h>
 
 /**
  * Class for filtering/copying graphs based on search criteria.  Vastly improves
- * performance in some cases.
+ * performance in some cases.  The graphs filtered by a query keep the
+ * statistics of the graph they came from (see Graph::stats()), since every
+ * edge that could match is still there, for the query planner to use.
  */
 class GraphFilter
 {
@@ -46,6 +52,24 @@ public:
      * @param g2  Empty graph to have nodes/edges added to it, based on the criteria.
      */
     static void filter(const CertGraph &g, time_t start, time_t end, CertGraph &g2);
+    /**
+     * Creates a copy of a given data graph by filtering out edges that don't match
+     * any of the query edges, given a query graph and the criteria.  Instead of
+     * testing one edge at a time, each attribute predicate of the query is
+     * applied to a whole block of an attribute column at once (using SIMD
+     * instructions when the CPU supports them).
+     * @param g  Graph we are copying/filtering.
+     * @param h  Query graph that we will be using.
+     * @param criteria  Criteria for the query graph.
+     * @param g2  Empty graph to have nodes/edges added to it, based on the criteria.
+     */
+    static void filter(const DataGraph &g, const DataGraph &h, const MatchCriteria_DataGraph &criteria, DataGraph &g2);
+private:
+    /**
+     * Clears the bits of the n rows of g, starting at row start, that don't
+     * satisfy the attribute restrictions of row hRow of h.
+     */
+    static void scanColumns(const AttributeColumns &g, int start, int n, const AttributeColumns &h, int hRow, uint64_t *bits);
 };
 
 #endif	/* GRAPHFILTER_H */
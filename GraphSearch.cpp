@@ -1,15 +1,48 @@
 #include <limits.h>
+#include <stdint.h>
 #include <unordered_set>
 #include <unordered_map>
-#include <stack>
+#include <algorithm>
 #include <iostream>
 #include "GraphSearch.h"
+#include "ColumnScan.h"
 #include "Graph.h"
 #include "Edge.h"
 #include <limits.h>
 
 using namespace std;
 
+namespace
+{
+    /** Smallest number of edges a node needs for the list of edges between it
+     * and another node to be worth looking up */
+    const int MIN_PAIR_LOOKUP = 4096;
+    
+    /** First index (from start on) in the sorted list with an edge >= e.
+     * Steps twice as far each time, then does a binary search, so it's fast
+     * when the edge is close to start. */
+    int gallop(const vector<int> &edgeIndexes, int start, int e)
+    {
+        int size = edgeIndexes.size();
+        int step = 1, end = start;
+        while(end < size && edgeIndexes[end] < e)
+        {
+            start = end + 1;
+            end += step;
+            step *= 2;
+        }
+        end = min(end, size);
+        return lower_bound(edgeIndexes.begin() + start, edgeIndexes.begin() + end, e) - edgeIndexes.begin();
+    }
+
+    /** Number of candidate edges findNextMatch() tests one at a time, before
+     * testing them in blocks */
+    const int MAX_SINGLE_TESTS = 4;
+    
+    /** Largest number of candidate edges tested together by ColumnScan::edgeNodes() */
+    const int SCAN_BLOCK = 16;
+}
+
 vector<GraphMatch> GraphSearch::findAllSubgraphs(const Graph &g, const Graph &h, int limit)
 {
     // If no criteria specified, just use the "dummy" criteria, that accepts everything.
@@ -19,10 +52,14 @@ vector<GraphMatch> GraphSearch::findAllSubgraphs(const Graph &g, const Graph &h,
 
 vector<GraphMatch> GraphSearch::findAllSubgraphs(const Graph &g, const Graph &h, const MatchCriteria &criteria, int limit)
 {    
-    // Store class data structures
+    // Store class data structures (and the criteria prepared for g and h, if any)
     _g = &g;
     _h = &h;
-    _criteria = &criteria;
+    _preparedCriteria = criteria.prepare(g, h);
+    _criteria = _preparedCriteria ? _preparedCriteria.get() : &criteria;
+    // (merging in any late edges now, so the search doesn't check for them
+    // every time it looks at an edge)
+    _gEdges = &g.edges();
     
     bool debugOutput = false;
     
@@ -37,10 +74,7 @@ vector<GraphMatch> GraphSearch::findAllSubgraphs(const Graph &g, const Graph &h,
     
     // Tables for mapping nodes and edges between the two graphs
     // -1 means no match has been assigned yet
-    _h2gNodes.clear();
-    _h2gNodes.resize(h.numNodes(),-1);
-    _g2hNodes.clear();
-    _g2hNodes.resize(n,-1);
+    this->resetNodeMaps(n, h.numNodes());
     
     // Perform subgraph search, storing results along the way
     int numAssigned = 0;
@@ -128,7 +162,7 @@ bool GraphSearch::search(int &numAssigned, vector<unordered_set<int>> &h2gPossib
                 if(_criteria->isEdgeMatch(*_g, g_e, *_h, hEdge.index()))
                 {
                     //matchingEdgeIndexes.push_back(g_e);
-                    matchingEdges.addEdge(_g->edges()[g_e], hEdge);
+                    matchingEdges.addEdge((*_gEdges)[g_e], hEdge);
                 }
             }
         }
@@ -202,10 +236,33 @@ vector<GraphMatch> GraphSearch::findOrderedSubgraphs(const Graph &g, const Graph
 
 vector<GraphMatch> GraphSearch::findOrderedSubgraphs(const Graph &g, const Graph &h, const MatchCriteria &criteria, int limit, int delta)
 {
-    // Store class data structures
+    // (edges that are waiting to be evicted are already out of the window)
+    return searchOrdered(g, h, criteria, limit, delta, g.firstEdge(), g.firstEdge());
+}
+
+vector<GraphMatch> GraphSearch::findNewOrderedSubgraphs(const Graph &g, const Graph &h, const MatchCriteria &criteria, int newEdge, int limit, int delta)
+{
+    const EdgeList &edges = g.edges();
+    if(newEdge >= edges.size())
+        return vector<GraphMatch>();
+    
+    // Matches with a new edge can't start more than delta before it
+    time_t start = edges[newEdge].time() - (time_t)delta;
+    int startEdge = lower_bound(edges.begin() + g.firstEdge(), edges.begin() + newEdge, start, 
+                                [](const Edge &e, time_t t) { return e.time() < t; }) - edges.begin();
+    return searchOrdered(g, h, criteria, limit, delta, startEdge, newEdge);
+}
+
+vector<GraphMatch> GraphSearch::searchOrdered(const Graph &g, const Graph &h, const MatchCriteria &criteria, int limit, int delta, int startEdge, int newEdge)
+{
+    // Store class data structures (and the criteria prepared for g and h, if any)
     _g = &g;
     _h = &h;
-    _criteria = &criteria;
+    _preparedCriteria = criteria.prepare(g, h);
+    _criteria = _preparedCriteria ? _preparedCriteria.get() : &criteria;
+    // (merging in any late edges now, so the search doesn't check for them
+    // every time it looks at an edge)
+    _gEdges = &g.edges();
     _delta = delta;
     
     bool debugOutput = false;
@@ -216,210 +273,393 @@ vector<GraphMatch> GraphSearch::findOrderedSubgraphs(const Graph &g, const Graph
     int n = _g->numNodes();
     int m = _g->numEdges();
     
-    // List of all edge indexes
+    // List of all edge indexes (only the ones added since the last search
+    // need to be filled in)
+    int numListed = min((int)_allEdges.size(), m);
     _allEdges.resize(m);
-    for(int i=0; i<m; i++)
+    for(int i=numListed; i<m; i++)
         _allEdges[i] = i;
     
     // Tables for mapping nodes and edges between the two graphs
     // -1 means no match has been assigned yet
-    _h2gNodes.clear();
-    _h2gNodes.resize(h.numNodes(),-1);
-    _g2hNodes.clear();
-    _g2hNodes.resize(n,-1);
-    
-    // Keeps track of the number of search edges mapped to a particular
-    // node, so we can know if we need to reset its mapping when removing
-    // edges from a search trail.
-    _numSearchEdgesForNode.clear();
-    _numSearchEdgesForNode.resize(n,0);
-            
-    // Stores all edges found that match our query.
-    // Stack used to backtrack when a particular search ends up a dead-end.
-    while(_sg_edgeStack.empty()==false) // Make sure it's empty to start
+    this->resetNodeMaps(n, h.numNodes());
+    
+    // Query edges that have to be joined with the partial matches, instead
+    // of following their nodes
+    this->findJoinEdges(startEdge);
+    
+    // Start from a more selective query edge, if it's cheaper (the matches
+    // have to be sorted afterward, so not when there's a limit)
+    _plan = QueryPlan::create(g, h, *_criteria, startEdge, delta, limit == INT_MAX);
+    
+    // Query edges whose nodes are both mapped by the edges before them can
+    // look up the edges between the two nodes, but the map of them (which
+    // has every edge in g) is only worth building if the search is going to
+    // test more edges than that
+    if(_plan.cost >= m)
     {
-        _sg_edgeStack.pop();
-        //_h_edgeStack.pop();
+        vector<bool> seen(h.numNodes(), false);
+        bool hasPairEdge = false;
+        for(int h_i : _plan.order)
+        {
+            const Edge &h_edge = h.edges()[h_i];
+            hasPairEdge = hasPairEdge || (seen[h_edge.source()] && seen[h_edge.dest()]);
+            seen[h_edge.source()] = true;
+            seen[h_edge.dest()] = true;
+        }
+        if(hasPairEdge)
+            g.buildPairEdges();
     }
-        
+    if(_plan.strategy == QueryPlan::ANCHORED)
+        return this->searchFromAnchor(startEdge, newEdge);
+            
+    // Each query edge's cursor keeps its place in the list of edges it's
+    // tested against, so backtracking to it continues right where it left off
+    int numQueryEdges = h.numEdges();
+    if(numQueryEdges == 0)
+        return results;
+    _cursors.assign(numQueryEdges, SearchCursor());
+    _newEdge = newEdge;
+
     // The edge from H we are trying to match in G
     int h_i = 0;
-    // The current edge from G we are testing out (yes, should start at -1)
-    int g_i = 0;
-         
+    this->startCursor(h_i, startEdge);
+
     // Loop until we can account for all subgraphs matching our edges
     while(true)
-    {           
-	// Time of the last matched edge, for delta comparison
-	//time_t lastEdgeTime = 0;
-	//if(_sg_edgeStack.empty()==false)
-	    //lastEdgeTime = g.edges()[_sg_edgeStack.top()].time();
-
-	// Time of current edge, for delta comparison
-	time_t curEdgeTime = 0;
-	if(g_i < m)
-	    curEdgeTime = g.edges()[g_i].time();
-
-        // If we've run out of edges, we need to pop the last edge used,
-        // and start the search back at the edge after that one
-        while(g_i >= m || (_sg_edgeStack.empty()==false && curEdgeTime - _firstEdgeTime > delta))
-        {             
-            // If the edge stack is empty, then we have no options left
+    {
+        // Find matching edge, if possible
+        SearchCursor &cursor = _cursors[h_i];
+        int g_i = this->findNextMatch(h_i, cursor);
+
+        // If we've run out of edges (or the ones left are past the delta),
+        // we need to give up on the last edge used, and continue the search
+        // for its query edge from the edge after it
+        if(g_i >= m)
+        {
+            // If no edges are matched, then we have no options left
             // and need to give up.
-            if(_sg_edgeStack.empty())            
-                return results;          
-                    
-            // Pop the stack
-            int last_g_i = _sg_edgeStack.top();            
-            _sg_edgeStack.pop(); 
-
-            // Get edge object
-            const Edge &g_edge = _g->edges()[last_g_i];            
+            if(h_i == 0)
+                return results;
+            h_i--;
             if(debugOutput)
-                cout << "Giving up on edge " << last_g_i << ": " << g_edge.source() << ", " << g_edge.dest() << endl;
+                cout << "Giving up on edge " << _cursors[h_i].edge << endl;
 
-            // Decrement the number of edges for the nodes in g_i
-            _numSearchEdgesForNode[g_edge.source()]--;
-            _numSearchEdgesForNode[g_edge.dest()]--;
+            // Unmap its nodes (if none of the other matched edges use them)
+            this->mapEdge(_cursors[h_i].edge, h_i, -1);
+            _cursors[h_i].pos++;
+            continue;
+        }
+        _plan.actualMatches[h_i]++;
 
-            // If any of them reach zero, then we need to remove the
-            // node mapping for that node, since none of our edges are
-            // currently using it (making it free to be re-assigned).
-            if(_numSearchEdgesForNode[g_edge.source()]==0)
-            {
-                int old_h_u = _g2hNodes[g_edge.source()];
-                _h2gNodes[old_h_u] = -1;
-                _g2hNodes[g_edge.source()] = -1;
-            }
-            if(_numSearchEdgesForNode[g_edge.dest()]==0)
-            {
-                int old_h_v = _g2hNodes[g_edge.dest()];
-                _h2gNodes[old_h_v] = -1;
-                _g2hNodes[g_edge.dest()] = -1;
-            }
+        // Test to see if whole graph is found
+        if(h_i+1 == numQueryEdges)
+        {
+            // Add new subgraph to the results
+            GraphMatch match;
+            for(int j=0; j<numQueryEdges; j++)
+                match.addEdge((*_gEdges)[_cursors[j].edge], _h->edges()[j]);
+            results.push_back(match);
+
+            // Don't increment h_i (or perform mappings), because we want
+            // to find if there are other alternative subgraphs for that edge.
+            // Test if we've reached our limit, and stop if we have.
+            if(results.size() >= limit)
+                return results;
+            cursor.pos++;
+        }
+        // Otherwise, add the edge and mappings to the subgraph search
+        // and continue on to find next edges.
+        else
+        {
+            // Set the first edge past the delta, if needed
+            if(h_i == 0)
+                _deltaEnd = _g->firstEdgeAt((*_gEdges)[g_i].time() + delta + 1, g_i);
+
+            // Map the nodes from each graph
+            this->mapEdge(g_i, h_i, 1);
 
-            // Decrement h_i, so that we can find a new one
-            h_i--;     
-            // Make sure we start the search immediately after the failed edge
-            g_i = last_g_i+1;   
-        }       
+            // Increment to next edge to find
+            h_i++;
+            this->startCursor(h_i, g_i+1);
+        }
+    }
+    return results;
+}
+
+void GraphSearch::startCursor(int h_i, int g_i)
+{
+    SearchCursor &cursor = _cursors[h_i];
+
+    // The last edge has to be a new one
+    if(h_i+1 == _h->numEdges() && g_i < _newEdge)
+        g_i = _newEdge;
+    cursor.first = g_i;
+
+    // The list of edges that match it, if none of its nodes can be mapped yet
+    // (see findJoinMatch()), or the list its mapped nodes pick
+    const vector<int> *edges = _isJoinEdge[h_i] ? &_joinEdges[h_i] : &this->searchEdgesFor(h_i);
+
+    // If it's the same list as last time, and g_i is after where it was,
+    // gallop forward from there (it's usually close) instead of searching
+    // the whole list
+    if(edges == cursor.edges && cursor.pos <= edges->size() && (cursor.pos == 0 || (*edges)[cursor.pos-1] < g_i))
+        cursor.pos = gallop(*edges, cursor.pos, g_i);
+    else
+        cursor.pos = findStart(g_i, *edges);
+    cursor.edges = edges;
+}
+
+const vector<int> &GraphSearch::searchEdgesFor(int h_i)
+{
+    const Edge &h_edge = _h->edges()[h_i];
+    int h_u = h_edge.source();
+    int h_v = h_edge.dest();
+    
+    // Look to see if nodes are already mapped, and just use those
+    // node edges, if so. (Much faster!)
+    if(_h2gNodes[h_u] >= 0 && _h2gNodes[h_v] >= 0)
+    {
+        const vector<int> &uEdges = _criteria->candidateOutEdges(*_g, _h2gNodes[h_u], *_h, h_i);
+        const vector<int> &vEdges = _criteria->candidateInEdges(*_g, _h2gNodes[h_v], *_h, h_i);
+        const vector<int> &edges = uEdges.size() < vEdges.size() ? uEdges : vEdges;
         
-        // Get query edge
-        const Edge &h_edge = _h->edges()[h_i];
-        int h_u = h_edge.source();
-        int h_v = h_edge.dest();
-                
-        // Find matching edge, if possible
-        g_i = this->findNextMatch(h_i, g_i);     
-                
-        if(g_i < m)
-        {            
-            // Test to see if whole graph is found
-            if(h_i+1 == _h->numEdges())
+        // Jump straight to the edges between the two nodes, if g has a list of
+        // them (it's only worth looking it up if both nodes have a lot of edges)
+        if(edges.size() >= MIN_PAIR_LOOKUP)
+        {
+            const vector<int> *pairEdges = _g->pairEdges(_h2gNodes[h_u], _h2gNodes[h_v]);
+            if(pairEdges != NULL && pairEdges->size() < edges.size())
             {
-                // Convert stack to vector
-                //vector<int> edges = convert(_sg_edgeStack); 
-                // Add the last edge to the list
-                //edges.push_back(g_i);
-                // Add new subgraph to the results
-                //results.push_back(edges);  
-                
-                // Create GraphMatch object
-                GraphMatch match = convert(_sg_edgeStack, g_i);
-                // Add new subgraph to the results
-                results.push_back(match);
-                
-                // Don't increment h_i (or perform mappings), because we want 
-                // to find if there are other alternative subgraphs for that edge.                
-		//cout << "Found subgraph #" << results.size() << endl;                
-                // Test if we've reached our limit, and stop if we have.
-                if(results.size() >= limit)
-                    return results;
-            }
-            // Otherwise, add the edge and mappings to the subgraph search
-            // and continue on to find next edges.
-            else
-            {  
-                // Get matched edge
-                const Edge &g_edge = _g->edges()[g_i];
-                int g_u = g_edge.source();
-                int g_v = g_edge.dest();
-
-		// Set the first edge time, if needed
-		if(_sg_edgeStack.empty())
-		    _firstEdgeTime = g_edge.time();
-                
-                // Map the nodes from each graph
-                _h2gNodes[h_u] = g_u;
-                _h2gNodes[h_v] = g_v;
-                _g2hNodes[g_u] = h_u;
-                _g2hNodes[g_v] = h_v;            
-
-                // Increment number of search edges for each node in our G edge
-                _numSearchEdgesForNode[g_u]++;
-                _numSearchEdgesForNode[g_v]++; 
-                
-                // Add it to the stack
-                _sg_edgeStack.push(g_i);
-                //_h_edgeStack.push(h_i);
-                                
-                // Increment to next edge to find
-                h_i++;  
+                _plan.pairLookups[h_i]++;
+                return *pairEdges;
             }
-        }    
-        
-        // Increment the edge to test
-        g_i++;
-    }  
+        }
+        return edges;
+    }
+    if(_h2gNodes[h_u] >= 0)
+        return _criteria->candidateOutEdges(*_g, _h2gNodes[h_u], *_h, h_i);
+    if(_h2gNodes[h_v] >= 0)
+        return _criteria->candidateInEdges(*_g, _h2gNodes[h_v], *_h, h_i);
+    
+    // Default is to search over all edges
+    // (or only those the criteria says could match, e.g., edges of one type)
+    const vector<int> *searchEdges = _criteria->candidateEdges(*_g, *_h, h_i);
+    if(searchEdges == NULL)
+        return _allEdges;
+    return *searchEdges;
+}
+
+vector<GraphMatch> GraphSearch::searchFromAnchor(int startEdge, int newEdge)
+{
+    int numQueryEdges = _h->numEdges();
+    _startEdge = startEdge;
+    _newEdge = newEdge;
+    _matchedEdges.assign(numQueryEdges, -1);
+    // Backward from the anchor, then forward
+    _anchorOrder = _plan.order;
+    
+    vector<GraphMatch> results;
+    this->extendAnchored(0, results);
+    
+    // Same order the normal search finds them in
+    sort(results.begin(), results.end(), [](const GraphMatch &a, const GraphMatch &b) { return a.edges() < b.edges(); });
     return results;
 }
 
-int GraphSearch::findNextMatch(int h_i, int g_i)
+void GraphSearch::extendAnchored(int pos, vector<GraphMatch> &results)
 {
-    bool debugOutput = false;
-        
-    // Get query edge
+    int numQueryEdges = _h->numEdges();
+    if(pos == numQueryEdges)
+    {
+        GraphMatch match;
+        for(int h_i=0; h_i<numQueryEdges; h_i++)
+            match.addEdge((*_gEdges)[_matchedEdges[h_i]], _h->edges()[h_i]);
+        results.push_back(match);
+        return;
+    }
+    
+    int h_i = _anchorOrder[pos];
     const Edge &h_edge = _h->edges()[h_i];
     int h_u = h_edge.source();
     int h_v = h_edge.dest();
+    bool isSelfLoop = h_u == h_v;
+    const vector<int> &searchEdges = this->searchEdgesFor(h_i);
+    
+    // The anchor, or an edge before the one matched to the next query edge (which
+    // can't be more than delta before the anchor), or an edge after the one
+    // matched to the previous query edge (within delta of the first edge)
+    bool isAnchor = pos == 0;
+    bool isBackward = !isAnchor && h_i < _anchorOrder[0];
+    int first = _startEdge;
+    if(h_i+1 == numQueryEdges)
+        first = max(first, _newEdge);
+    if(!isAnchor && !isBackward)
+        first = max(first, _matchedEdges[h_i-1] + 1);
+    int last = isBackward ? _matchedEdges[h_i+1] : _g->numEdges();
+    // (the edges after the anchor are checked by time, since there are
+    // too many partial matches to look up the last edge for each one)
+    time_t endTime = isAnchor || isBackward ? 0 : (*_gEdges)[_matchedEdges[0]].time() + _delta;
+    
+    int start = findStart(first, searchEdges);
+    int end = findStart(last, searchEdges);
+    for(int k=0; k<end-start; k++)
+    {
+        int i = isBackward ? end-1-k : start+k;
+        int g_i = searchEdges[i];
         
-    // Default is to search over all edges starting at g_i
-    const vector<int> *searchEdges = &_allEdges;
+        // If we've gone past our delta, stop the search
+        if(isBackward && g_i < _anchorDeltaStart)
+            break;
+        const Edge &g_edge = (*_gEdges)[g_i];
+        if(!isAnchor && !isBackward && g_edge.time() > endTime)
+            break;
+        int g_u = g_edge.source();
+        int g_v = g_edge.dest();
         
-    // Look to see if nodes are already mapped, and just use those
-    // node edges, if so. (Much faster!)
-    if(_h2gNodes[h_u] >= 0 && _h2gNodes[h_v] >= 0)
+        // Same tests as the normal search
+        if((g_u == g_v) != isSelfLoop)
+            continue;
+        if(!(_h2gNodes[h_u] == g_u || (_h2gNodes[h_u] < 0 && _g2hNodes[g_u] < 0)))
+            continue;
+        if(!(_h2gNodes[h_v] == g_v || (_h2gNodes[h_v] < 0 && _g2hNodes[g_v] < 0)))
+            continue;
+        if(!_criteria->isEdgeMatch(*_g, g_i, *_h, h_i))
+            continue;
+        
+        if(isAnchor)
+            _anchorDeltaStart = _g->firstEdgeAt(g_edge.time() - _delta, _startEdge);
+        _matchedEdges[h_i] = g_i;
+        _plan.actualMatches[h_i]++;
+        this->mapEdge(g_i, h_i, 1);
+        this->extendAnchored(pos+1, results);
+        this->mapEdge(g_i, h_i, -1);
+    }
+}
+
+void GraphSearch::resetNodeMaps(int numGNodes, int numHNodes)
+{
+    // The nodes in G that are still mapped are the ones the query nodes map to
+    for(int g_v : _h2gNodes)
     {
-        const vector<int> &uEdges = _g->nodes()[_h2gNodes[h_u]].outEdges();
-        const vector<int> &vEdges = _g->nodes()[_h2gNodes[h_v]].inEdges();
-        if(uEdges.size() < vEdges.size())
-            searchEdges = &uEdges;
-        else
-            searchEdges = &vEdges;
+        if(g_v >= 0)
+        {
+            _g2hNodes[g_v] = -1;
+            _numSearchEdgesForNode[g_v] = 0;
+        }
     }
-    else if(_h2gNodes[h_u] >= 0)
+    _h2gNodes.assign(numHNodes, -1);
+
+    // (the tables only grow, since G only gets more nodes, and any past its
+    // end are never mapped)
+    if(_g2hNodes.size() < numGNodes)
     {
-        searchEdges = &_g->nodes()[_h2gNodes[h_u]].outEdges();
+        _g2hNodes.resize(numGNodes, -1);
+        _numSearchEdgesForNode.resize(numGNodes, 0);
     }
-    else if(_h2gNodes[h_v] >= 0)
+}
+
+void GraphSearch::mapEdge(int g_i, int h_i, int count)
+{
+    const Edge &g_edge = (*_gEdges)[g_i];
+    const Edge &h_edge = _h->edges()[h_i];
+    int g_nodes[2] = { g_edge.source(), g_edge.dest() };
+    int h_nodes[2] = { h_edge.source(), h_edge.dest() };
+    for(int j=0; j<2; j++)
     {
-        searchEdges = &_g->nodes()[_h2gNodes[h_v]].inEdges();
+        // Nodes stay mapped as long as any of the matched edges use them
+        _numSearchEdgesForNode[g_nodes[j]] += count;
+        if(_numSearchEdgesForNode[g_nodes[j]] == 0)
+        {
+            _h2gNodes[h_nodes[j]] = -1;
+            _g2hNodes[g_nodes[j]] = -1;
+        }
+        else
+        {
+            _h2gNodes[h_nodes[j]] = g_nodes[j];
+            _g2hNodes[g_nodes[j]] = h_nodes[j];
+        }
     }
+}
+
+void GraphSearch::findJoinEdges(int startEdge)
+{
+    int numQueryEdges = _h->numEdges();
+    _isJoinEdge.assign(numQueryEdges, false);
+    _joinEdges.resize(numQueryEdges);
+    _joinNext.assign(numQueryEdges, 0);
     
-    // Find starting place in the list
-    int start = findStart(g_i, *searchEdges);
-    
-    // If no starting place can be found, just return that it's not possible
-    if(start == searchEdges->size())
-        return _g->numEdges();
-    /*if(debugOutput)
+    vector<bool> seen(_h->numNodes(), false);
+    for(int h_i=0; h_i<numQueryEdges; h_i++)
     {
-        cout << "Looking for an edge >= " << g_i << endl;
-        cout << "Found this one: " << 
-    }*/
-    
-    // Perform search
-    return findNextMatch(h_i, *searchEdges, start);
+        const Edge &h_edge = _h->edges()[h_i];
+        // (the first edge is only searched for once anyway)
+        _isJoinEdge[h_i] = h_i > 0 && !seen[h_edge.source()] && !seen[h_edge.dest()];
+        seen[h_edge.source()] = true;
+        seen[h_edge.dest()] = true;
+        
+        _joinEdges[h_i].clear();
+        if(_isJoinEdge[h_i])
+        {
+            const vector<int> *searchEdges = _criteria->candidateEdges(*_g, *_h, h_i);
+            if(searchEdges == NULL)
+                searchEdges = &_allEdges;
+            _joinNext[h_i] = findStart(startEdge, *searchEdges);
+        }
+    }
+}
+
+int GraphSearch::findJoinMatch(int h_i, SearchCursor &cursor)
+{
+    const Edge &h_edge = _h->edges()[h_i];
+    bool isSelfLoop = h_edge.source() == h_edge.dest();
+    vector<int> &joinEdges = _joinEdges[h_i];
+    int m = _g->numEdges();
+
+    // The search only moves forward from the start edge, so anything before
+    // _joinNext has already been tested
+    while(true)
+    {
+        if(cursor.pos == joinEdges.size())
+        {
+            // Test more edges, until one matches (or they're past the delta)
+            const vector<int> *searchEdges = _criteria->candidateEdges(*_g, *_h, h_i);
+            if(searchEdges == NULL)
+                searchEdges = &_allEdges;
+            int &next = _joinNext[h_i];
+            bool found = false;
+            while(next < searchEdges->size() && !found)
+            {
+                int e = (*searchEdges)[next];
+                const Edge &g_edge = (*_gEdges)[e];
+                if(e >= _deltaEnd)
+                    return m;
+                next++;
+                if((g_edge.source() == g_edge.dest()) == isSelfLoop && _criteria->isEdgeMatch(*_g, e, *_h, h_i))
+                {
+                    joinEdges.push_back(e);
+                    found = true;
+                }
+            }
+            if(!found)
+                return m;
+        }
+
+        int e = joinEdges[cursor.pos];
+        const Edge &g_edge = (*_gEdges)[e];
+
+        // If we've gone past our delta, stop the search
+        if(e >= _deltaEnd)
+            return m;
+        // The nodes can't already be used by the partial match
+        // (and edges added to the list can be before the cursor's first one)
+        if(e >= cursor.first && _g2hNodes[g_edge.source()] < 0 && _g2hNodes[g_edge.dest()] < 0)
+        {
+            cursor.edge = e;
+            return e;
+        }
+        cursor.pos++;
+    }
 }
 
 int GraphSearch::findStart(int g_i, const std::vector<int> &edgeIndexes)
@@ -475,7 +715,7 @@ int GraphSearch::findStart(int g_i, const std::vector<int> &edgeIndexes)
     }
 }
 
-int GraphSearch::findNextMatch(int h_i, const std::vector<int> &edgesToSearch, int startIndex)
+int GraphSearch::findNextMatch(int h_i, SearchCursor &cursor)
 {
     bool debugOutput = false;
     
@@ -483,24 +723,31 @@ int GraphSearch::findNextMatch(int h_i, const std::vector<int> &edgesToSearch, i
     const Edge &h_edge = _h->edges()[h_i];
     int h_u = h_edge.source();
     int h_v = h_edge.dest();
+    
+    // None of its nodes can be mapped yet
+    if(_isJoinEdge[h_i])
+        return this->findJoinMatch(h_i, cursor);
 
-    // Check the time against the previous matched edge, if any exist
-    bool checkTime = _sg_edgeStack.empty()==false;
+    // Only the edges within delta of the first matched edge, if any exist
+    int end = h_i == 0 ? _g->numEdges() : _deltaEnd;
     
-    // Loop over all the edges to search
-    for(int i=startIndex; i<edgesToSearch.size(); i++)
+    // Usually one of the first few edges matches, so they're tested one at
+    // a time, and if none do, the rest are tested in blocks
+    const vector<int> &edgesToSearch = *cursor.edges;
+    int singleEnd = min((int)edgesToSearch.size(), cursor.pos + MAX_SINGLE_TESTS);
+    for(; cursor.pos<singleEnd; cursor.pos++)
     {
         // Get the index of our edge in G
-        int g_i = edgesToSearch[i];
+        int g_i = edgesToSearch[cursor.pos];
+        
+	// If we've gone past our delta, stop the search
+	if(g_i >= end)
+	    return _g->numEdges();
         
         // Get original edge
-        const Edge &g_edge = _g->edges()[g_i];
+        const Edge &g_edge = (*_gEdges)[g_i];
         int g_u = g_edge.source();
         int g_v = g_edge.dest();     
-
-	// If we've gone past our delta, stop the search
-	if(checkTime && g_edge.time() - _firstEdgeTime > _delta)
-	    return _g->numEdges();
         
         if(debugOutput)
         {
@@ -524,37 +771,65 @@ int GraphSearch::findNextMatch(int h_i, const std::vector<int> &edgesToSearch, i
 		    {   
 			if(debugOutput)
 			    cout << "Edge " << g_i << ": " << g_u << ", " << g_v << " is a match" << endl;
+			cursor.edge = g_i;
 			return g_i;
 		    }
 		}
 	    }
 	}
     }
-    // If no match found, return the number of edges
-    return _g->numEdges();
-}
-
-vector<int> GraphSearch::convert(stack<int> s)
-{
-    vector<int> v(s.size());
-    for(int i=v.size()-1; i>=0; i--)
-    {
-        v[i] = s.top();
-        s.pop();
-    }
-    return v;
+    if(cursor.pos == edgesToSearch.size())
+        return _g->numEdges();
+    
+    return this->scanCandidates(h_i, cursor, end);
 }
 
-GraphMatch GraphSearch::convert(const std::stack<int> &s, int g_lastEdge)
+int GraphSearch::scanCandidates(int h_i, SearchCursor &cursor, int end)
 {
-    GraphMatch gm;
-    vector<int> gEdges = convert(s);
-    gEdges.push_back(g_lastEdge);
-    for(int h_i=0; h_i<gEdges.size(); h_i++)
+    bool debugOutput = false;
+    const Edge &h_edge = _h->edges()[h_i];
+    bool isSelfLoop = h_edge.source() == h_edge.dest();
+    int mappedU = _h2gNodes[h_edge.source()], mappedV = _h2gNodes[h_edge.dest()];
+    
+    // Test the edges to search a block at a time; the ones whose nodes fit
+    // the partial match go on to the criteria
+    const vector<int> &edgesToSearch = *cursor.edges;
+    const EdgeNodes *edgeNodes = _gEdges->nodes();
+    static_assert(sizeof(EdgeNodes) == 2*sizeof(int), "Edge nodes have to be stored as pairs of ints");
+    const int *g2hNodes = _g2hNodes.data();
+    while(cursor.pos < edgesToSearch.size())
     {
-        int g_i = gEdges[h_i];
-        gm.addEdge(_g->edges()[g_i], _h->edges()[h_i]);
+        // (the edges past the end aren't loaded)
+        int count = min(SCAN_BLOCK, (int)edgesToSearch.size() - cursor.pos);
+        const int *candidates = &edgesToSearch[cursor.pos];
+        int numBeforeEnd = count;
+        if(candidates[count-1] >= end)
+            numBeforeEnd = lower_bound(candidates, candidates + count, end) - candidates;
+        uint32_t mask = ColumnScan::edgeNodes((const int*)edgeNodes, candidates, numBeforeEnd, isSelfLoop,
+                                              mappedU, mappedV, g2hNodes);
+        while(mask != 0)
+        {
+            int k = __builtin_ctz(mask);
+            mask &= mask - 1;
+            int g_i = candidates[k];
+            
+            // Test if metadata criteria is a match
+            if(_criteria->isEdgeMatch(*_g,g_i,*_h,h_i))
+            {
+                if(debugOutput)
+                    cout << "Edge " << g_i << ": " << edgeNodes[g_i].source << ", " << edgeNodes[g_i].dest << " is a match" << endl;
+                cursor.pos += k;
+                cursor.edge = g_i;
+                return g_i;
+            }
+        }
+        
+        // If we've gone past our delta, stop the search
+        cursor.pos += numBeforeEnd;
+        if(numBeforeEnd < count)
+            return _g->numEdges();
     }
-    return gm;
+    // If no match found, return the number of edges
+    return _g->numEdges();
 }
 
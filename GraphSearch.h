@@ -11,13 +11,17 @@
 #include "Graph.h"
 #include "MatchCriteria.h"
 #include <limits.h>
+#include <memory>
 #include <vector>
-#include <stack>
 #include <unordered_set>
 #include "GraphMatch.h"
+#include "QueryPlan.h"
 
 /**
- * Main class for performing subgraph searches.
+ * Main class for performing subgraph searches.  Each thread needs its own
+ * GraphSearch, but they can share a criteria (anything it precomputes goes in
+ * a copy each search owns, see MatchCriteria::prepare()), and a graph searched
+ * from more than one thread at a time has to be frozen first (see Graph::freeze()).
  */
 class GraphSearch
 {
@@ -53,6 +57,21 @@ public:
      */
     std::vector<GraphMatch> findOrderedSubgraphs(const Graph &g, const Graph &h, const MatchCriteria &criteria, int limit = INT_MAX, int delta = INT_MAX);
     
+    /**
+     * Same as findOrderedSubgraphs(), except it only finds the matching 
+     * subgraphs that use at least one of the edges from newEdge on (e.g., 
+     * edges that just arrived).  Only the edges within delta of newEdge are 
+     * searched, so this is much quicker than searching the whole graph again.
+     * @param g  The directed graph to search on.
+     * @param h  The directed query graph we are trying to match.
+     * @param criteria  Polymorphic class specifies whether or not two given edges match the query criteria.
+     * @param newEdge  Index of the first new edge in g (in chronological order).
+     * @param limit  The max number of subgraphs to find.
+     * @param delta  The max time duration allowed between edge matches.
+     * @return  List of subgraphs that match h, and end at or after newEdge.
+     */
+    std::vector<GraphMatch> findNewOrderedSubgraphs(const Graph &g, const Graph &h, const MatchCriteria &criteria, int newEdge, int limit = INT_MAX, int delta = INT_MAX);
+    
     /** 
      * Performs a subgraph search, in which the edge order does NOT matter,
      * and date/time of events is usually ignored.
@@ -78,8 +97,16 @@ public:
      */
     std::vector<GraphMatch> findAllSubgraphs(const Graph &g, const Graph &h, const MatchCriteria &criteria, int limit = INT_MAX);
     
+    /** The plan used by the last ordered search (with the actual number of
+     * partial matches found for each query edge). */
+    const QueryPlan &plan() const { return _plan; }
+    
 private:
     
+    /** Does the ordered search, with matches starting at or after startEdge,
+     * and ending at or after newEdge. */
+    std::vector<GraphMatch> searchOrdered(const Graph &g, const Graph &h, const MatchCriteria &criteria, int limit, int delta, int startEdge, int newEdge);
+    
     /** Creates map of which nodes in G can map to the nodes we are searching for from H */
     std::vector<std::unordered_set<int>> mapPossibleNodes();
     
@@ -92,15 +119,64 @@ private:
     /** Returns true if the number assigned all match up with the appropriate edges */
     bool matchesSoFar(int numAssigned);
     
-    /** Picks an efficient list of edge indexes to search from before searching through them
-     * for a edge that matches query edge h_i. The return value is the index of
-     * the matching edge in G.  If no edge is found, it will return the size of edges in G. */
-    int findNextMatch(int h_i, int startIndex);
+    /** Where the ordered search is in the list of edges it's testing for one
+     * query edge */
+    struct SearchCursor
+    {
+        SearchCursor() : edges(NULL), pos(0), first(0), edge(-1) {}
+        // List of edges in G being tested, position in it, the first edge
+        // that can match, and the edge that matched last
+        const std::vector<int> *edges;
+        int pos, first, edge;
+    };
+    
+    /** Picks an efficient list of edge indexes for query edge h_i to search
+     * through (based on which of its nodes are mapped), and moves its cursor
+     * to the first edge >= g_i in it. */
+    void startCursor(int h_i, int g_i);
     
-    /** Searches through edge indexes listed in edgesToSearch (starting at the startIndex)
-     * for a edge that matches query edge h_i. The return value is the index of
-     * the matching edge in G.  If no edge is found, it will return the size of edges in G. */
-    int findNextMatch(int h_i, const std::vector<int> &edgesToSearch, int startIndex);
+    /** Searches through the cursor's list of edges (starting at its position)
+     * for a edge that matches query edge h_i, and leaves the cursor on it.
+     * The return value is the index of the matching edge in G.  If no edge
+     * is found, it will return the size of edges in G. */
+    int findNextMatch(int h_i, SearchCursor &cursor);
+    
+    /** Continues findNextMatch()'s search (up to the given end edge) a block of
+     * edges at a time, using ColumnScan::edgeNodes() to test their nodes. */
+    int scanCandidates(int h_i, SearchCursor &cursor, int end);
+    
+    /** Does the ordered search by matching the plan's anchor query edge first, then
+     * the query edges before it (going backward in time), and then the ones
+     * after it (going forward).  Finds the same matches as the normal search,
+     * and returns them in the same order. */
+    std::vector<GraphMatch> searchFromAnchor(int startEdge, int newEdge);
+    
+    /** Matches the pos-th query edge in _anchorOrder, and the ones after it,
+     * adding any complete matches to results. */
+    void extendAnchored(int pos, std::vector<GraphMatch> &results);
+    
+    /** Clears the node mappings left by the last search, and makes room for
+     * the given number of nodes in G and H.  Only the nodes the last search
+     * still had mapped are cleared, so a new search doesn't cost O(n). */
+    void resetNodeMaps(int numGNodes, int numHNodes);
+    
+    /** Maps (or unmaps, if count is -1) the nodes of G edge g_i to those of query edge h_i */
+    void mapEdge(int g_i, int h_i, int count);
+    
+    /** Returns the list of edges in G to search through for query edge h_i,
+     * based on which of its nodes are already mapped */
+    const std::vector<int> &searchEdgesFor(int h_i);
+    
+    /** Finds the query edges (after the first) that don't share a node with
+     * any of the edges before them, and clears their candidate lists. */
+    void findJoinEdges(int startEdge);
+    
+    /** Same as findNextMatch(), for a query edge that doesn't share a node with
+     * the edges before it.  Whether an edge can match it doesn't depend on the
+     * rest of the partial match (other than time and which nodes are used), so
+     * the edges that match it are only tested once, and kept in a list that
+     * every partial match searches (instead of all the edges after g_i). */
+    int findJoinMatch(int h_i, SearchCursor &cursor);
     
     /**
      * Performs binary search to find best starting place.
@@ -110,22 +186,37 @@ private:
      */
     int findStart(int g_i, const std::vector<int> &edgeIndexes);
     
-    /** Converts the given stack into a vector, without modifying it */
-    std::vector<int> convert(std::stack<int> s);
-    
-    /** Converts the given stack and final edge to a GraphMatch object,
-     without modifying the stack. */
-    GraphMatch convert(const std::stack<int> &s, int g_lastEdge);
-    
     // Private data members
     const Graph *_g, *_h;
+    // Chronological edges of g
+    const EdgeList *_gEdges;
     const MatchCriteria *_criteria;
+    // Criteria prepared for this search (see MatchCriteria::prepare()), if any
+    std::unique_ptr<MatchCriteria> _preparedCriteria;
     int _delta;
-    time_t _firstEdgeTime;
+    // First edge in G that's more than delta after the first matched edge
+    int _deltaEnd;
+    // Node mappings between G and H (-1 if not mapped), and the number of
+    // matched edges using each node in G.  These are kept between searches,
+    // and only the mapped nodes are reset (see resetNodeMaps()).
     std::vector<int> _h2gNodes, _g2hNodes;
     std::vector<int> _numSearchEdgesForNode;
-    std::stack<int> _sg_edgeStack; //, _h_edgeStack;
+    // Cursor for each query edge (the matched edges are the search's stack)
+    std::vector<SearchCursor> _cursors;
     std::vector<int> _allEdges;
+    // For each query edge that doesn't share a node with the ones before it, the
+    // edges in G found to match it so far (in order), and where in the list of
+    // edges to test (_allEdges or the criteria's candidates) to continue from
+    std::vector<bool> _isJoinEdge;
+    std::vector<std::vector<int>> _joinEdges;
+    std::vector<int> _joinNext;
+    // For anchored searches: order the query edges are matched in, the G edge
+    // matched to each query edge, the first edge within delta before the
+    // anchor's match, and the range of edges the matches have to start and end in
+    std::vector<int> _anchorOrder, _matchedEdges;
+    int _anchorDeltaStart;
+    int _startEdge, _newEdge;
+    QueryPlan _plan;
 };
 
 #endif	/* GRAPHSEARCH_H */
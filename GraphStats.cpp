@@ -0,0 +1,256 @@
+#include "GraphStats.h"
+#include "CertGraph.h"
+#include "DataGraph.h"
+#include "Parallel.h"
+#include "TypeDictionary.h"
+#include <algorithm>
+#include <mutex>
+
+using namespace std;
+
+namespace
+{
+    /** Adds the counts of one histogram to another */
+    void addCounts(vector<int64_t> &to, const vector<int64_t> &from)
+    {
+        if(to.size() < from.size())
+            to.resize(from.size(), 0);
+        for(int i=0; i<from.size(); i++)
+            to[i] += from[i];
+    }
+
+    void addToHistogram(vector<int64_t> &histogram, int64_t value)
+    {
+        int b = GraphStats::bucket(value);
+        if(histogram.size() <= b)
+            histogram.resize(b+1, 0);
+        histogram[b]++;
+    }
+
+    /** Smallest number of nodes or edges worth starting a thread for */
+    const int MIN_PER_THREAD = 1 << 14;
+}
+
+GraphStats::GraphStats()
+{
+    numNodes = 0;
+    numEdges = 0;
+    startTime = 0;
+    endTime = 0;
+}
+
+int GraphStats::bucket(int64_t value)
+{
+    int b = 0;
+    while(value > 0)
+    {
+        value >>= 1;
+        b++;
+    }
+    return b;
+}
+
+double GraphStats::meanDegree() const
+{
+    // (nodes without edges aren't counted)
+    int64_t numActive = 0;
+    for(const auto &histogram : degreeHistograms)
+    {
+        for(int b=1; b<histogram.second.size(); b++)
+            numActive += histogram.second[b];
+    }
+    return numActive > 0 ? 2.0 * numEdges / numActive : 0;
+}
+
+double GraphStats::edgesPerSecond() const
+{
+    time_t span = endTime - startTime;
+    return span > 0 ? (double)numEdges / span : numEdges;
+}
+
+GraphStats GraphStats::compute(const DataGraph &g)
+{
+    GraphStats stats;
+    int n = g.numNodes();
+    int m = g.edges().size();
+
+    // Group the nodes by their type attribute, if they have one
+    // (the k-th VARCHAR column is the k-th VARCHAR data attribute)
+    const AttributesDef &nodeDef = g.nodeAttributesDef();
+    const AttributeColumns &nodeColumns = g.nodeColumns();
+    int typeColumn = -1;
+    for(int i=0, k=0; i<nodeDef.attributeNames().size(); i++)
+    {
+        if(nodeDef.attributeTypes()[i] != DATA || nodeDef.dataTypes()[i] != STRING)
+            continue;
+        if(nodeDef.attributeNames()[i] == "type")
+            typeColumn = k;
+        k++;
+    }
+    vector<int> nodeTypes(n, 0);
+    vector<string> typeNames(1, "");
+    if(typeColumn >= 0 && nodeColumns.size() >= n)
+    {
+        for(int code=0; code<nodeColumns.numStringValues(typeColumn); code++)
+            typeNames.push_back(nodeColumns.stringValue(typeColumn, code));
+        const int *codes = nodeColumns.stringColumn(typeColumn);
+        for(int v=0; v<n; v++)
+            nodeTypes[v] = codes[v] + 1;
+    }
+    stats.computeCommon(g, nodeTypes, typeNames, [&g](int v) { return g.getName(v); });
+
+    // Edges with each value of each VARCHAR attribute
+    const AttributesDef &edgeDef = g.edgeAttributesDef();
+    const AttributeColumns &edgeColumns = g.edgeColumns();
+    if(edgeColumns.size() < m)
+        return stats;
+    for(int i=0, k=0; i<edgeDef.attributeNames().size(); i++)
+    {
+        if(edgeDef.attributeTypes()[i] != DATA || edgeDef.dataTypes()[i] != STRING)
+            continue;
+        const int *codes = edgeColumns.stringColumn(k);
+        int numValues = edgeColumns.numStringValues(k);
+        vector<int64_t> counts(numValues, 0);
+        mutex lock;
+        Parallel::forRange(m, MIN_PER_THREAD, 1, [&](int begin, int end)
+        {
+            vector<int64_t> chunkCounts(numValues, 0);
+            for(int e=begin; e<end; e++)
+                chunkCounts[codes[e]]++;
+            lock_guard<mutex> guard(lock);
+            addCounts(counts, chunkCounts);
+        });
+        map<string,int64_t> &valueCounts = stats.edgeValueCounts[edgeDef.attributeNames()[i]];
+        for(int code=0; code<numValues; code++)
+        {
+            if(counts[code] > 0)
+                valueCounts[edgeColumns.stringValue(k, code)] = counts[code];
+        }
+        k++;
+    }
+    return stats;
+}
+
+GraphStats GraphStats::compute(const CertGraph &g)
+{
+    GraphStats stats;
+    int n = g.numNodes();
+    int m = g.edges().size();
+
+    // Type IDs are shared by all the graphs, so only the ones used get a name
+    vector<int> nodeTypes(n);
+    vector<string> typeNames;
+    unordered_map<int,int> typeIndexes;
+    for(int v=0; v<n; v++)
+    {
+        int id = g.getNodeTypeId(v);
+        auto iter = typeIndexes.find(id);
+        if(iter == typeIndexes.end())
+        {
+            iter = typeIndexes.insert(make_pair(id, (int)typeNames.size())).first;
+            typeNames.push_back(id >= 0 ? TypeDictionary::name(id) : "");
+        }
+        nodeTypes[v] = iter->second;
+    }
+    stats.computeCommon(g, nodeTypes, typeNames, [&g](int v) { return g.getLabel(v); });
+
+    // Edges of each type
+    unordered_map<int,int64_t> counts;
+    mutex lock;
+    Parallel::forRange(m, MIN_PER_THREAD, 1, [&](int begin, int end)
+    {
+        unordered_map<int,int64_t> chunkCounts;
+        for(int e=begin; e<end; e++)
+            chunkCounts[g.getEdgeTypeId(e)]++;
+        lock_guard<mutex> guard(lock);
+        for(const auto &count : chunkCounts)
+            counts[count.first] += count.second;
+    });
+    map<string,int64_t> &typeCounts = stats.edgeValueCounts["type"];
+    for(const auto &count : counts)
+        typeCounts[count.first >= 0 ? TypeDictionary::name(count.first) : ""] = count.second;
+    return stats;
+}
+
+void GraphStats::computeCommon(const Graph &g, const vector<int> &nodeTypes, const vector<string> &typeNames,
+                               const function<string(int)> &nameOf)
+{
+    const EdgeList &edges = g.edges();
+    int n = g.numNodes();
+    int m = edges.size();
+    int first = g.firstEdge();
+    numNodes = n;
+    numEdges = m - first;
+    if(numEdges > 0)
+    {
+        startTime = edges[first].time();
+        endTime = edges.back().time();
+    }
+
+    // Time between consecutive edges
+    mutex lock;
+    Parallel::forRange(numEdges, MIN_PER_THREAD, 1, [&](int begin, int end)
+    {
+        vector<int64_t> histogram;
+        for(int i=max(begin,1); i<end; i++)
+            addToHistogram(histogram, edges[first+i].time() - edges[first+i-1].time());
+        lock_guard<mutex> guard(lock);
+        addCounts(interEventTimes, histogram);
+    });
+
+    // Degrees, time between each node's edges, and the busiest nodes
+    vector<vector<int64_t>> degrees(typeNames.size());
+    vector<pair<int64_t,int>> busiest;
+    Parallel::forRange(n, MIN_PER_THREAD, 1, [&](int begin, int end)
+    {
+        vector<vector<int64_t>> chunkDegrees(typeNames.size());
+        vector<int64_t> histogram;
+        vector<pair<int64_t,int>> chunkBusiest;
+        for(int v=begin; v<end; v++)
+        {
+            const Node &node = g.nodes()[v];
+            const vector<int> &outEdges = node.outEdges(), &inEdges = node.inEdges();
+            // (edges waiting to be evicted are at the start of the lists)
+            auto outStart = lower_bound(outEdges.begin(), outEdges.end(), first);
+            auto inStart = lower_bound(inEdges.begin(), inEdges.end(), first);
+            int64_t degree = (outEdges.end() - outStart) + (inEdges.end() - inStart);
+            addToHistogram(chunkDegrees[nodeTypes[v]], degree);
+
+            // Merge the out and in edges, in order
+            auto o = outStart, i = inStart;
+            time_t lastTime = 0;
+            bool hasLast = false;
+            while(o != outEdges.end() || i != inEdges.end())
+            {
+                int e = (i == inEdges.end() || (o != outEdges.end() && *o < *i)) ? *o++ : *i++;
+                time_t t = edges[e].time();
+                if(hasLast)
+                    addToHistogram(histogram, t - lastTime);
+                lastTime = t;
+                hasLast = true;
+            }
+
+            // Keep the busiest nodes of the chunk
+            chunkBusiest.push_back(make_pair(degree, v));
+            if(chunkBusiest.size() >= 2 * NUM_BUSIEST)
+            {
+                nth_element(chunkBusiest.begin(), chunkBusiest.begin() + NUM_BUSIEST, chunkBusiest.end(), greater<pair<int64_t,int>>());
+                chunkBusiest.resize(NUM_BUSIEST);
+            }
+        }
+        lock_guard<mutex> guard(lock);
+        for(int t=0; t<typeNames.size(); t++)
+            addCounts(degrees[t], chunkDegrees[t]);
+        addCounts(nodeInterEventTimes, histogram);
+        busiest.insert(busiest.end(), chunkBusiest.begin(), chunkBusiest.end());
+    });
+
+    for(int t=0; t<typeNames.size(); t++)
+    {
+        if(!degrees[t].empty())
+            degreeHistograms[typeNames[t]] = degrees[t];
+    }
+    sort(busiest.begin(), busiest.end(), greater<pair<int64_t,int>>());
+    for(int i=0; i<busiest.size() && i<NUM_BUSIEST && busiest[i].first > 0; i++)
+        busiestNodes.push_back(make_pair(nameOf(busiest[i].second), busiest[i].first));
+}
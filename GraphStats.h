@@ -0,0 +1,64 @@
+#ifndef GRAPH_STATS_H
+#define GRAPH_STATS_H
+
+#include <stdint.h>
+#include <time.h>
+#include <functional>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+class Graph;
+class DataGraph;
+class CertGraph;
+
+/**
+ * Catalog of statistics about a data graph, computed in one parallel pass
+ * when it's loaded (see FileIO), so planning and pruning decisions don't
+ * have to scan the graph again.  Snapshots store it along with the graph.
+ *
+ * Histograms have log2 buckets: bucket 0 counts the zeros, and bucket b
+ * counts the values in [2^(b-1), 2^b).
+ */
+class GraphStats
+{
+public:
+    /** Number of busiest nodes kept */
+    static const int NUM_BUSIEST = 10;
+
+    GraphStats();
+    /** Computes the stats for a graph with attributes.  Nodes are grouped by
+     * their "type" attribute (if they have one), and edges are counted for
+     * each value of each VARCHAR attribute. */
+    static GraphStats compute(const DataGraph &g);
+    /** Computes the stats for a CERT graph, by node type and edge type */
+    static GraphStats compute(const CertGraph &g);
+    /** Histogram bucket for the given value */
+    static int bucket(int64_t value);
+    /** Average number of edges (in and out) per node that has any */
+    double meanDegree() const;
+    /** Average number of edges per second */
+    double edgesPerSecond() const;
+
+    int64_t numNodes, numEdges;
+    time_t startTime, endTime;
+    /** Histogram of the degree (in + out) of the nodes of each type */
+    std::map<std::string, std::vector<int64_t>> degreeHistograms;
+    /** Number of edges with each value, for each attribute (or "type") */
+    std::map<std::string, std::map<std::string, int64_t>> edgeValueCounts;
+    /** Histograms of the time between consecutive edges, and between
+     * consecutive edges of the same node */
+    std::vector<int64_t> interEventTimes, nodeInterEventTimes;
+    /** Names and degrees of the nodes with the most edges */
+    std::vector<std::pair<std::string, int64_t>> busiestNodes;
+
+private:
+    /** Computes everything that's the same for every kind of graph.
+     * @param nodeTypes  Type of each node (as an index into typeNames).
+     * @param nameOf  Gets the name of a node. */
+    void computeCommon(const Graph &g, const std::vector<int> &nodeTypes, const std::vector<std::string> &typeNames,
+                       const std::function<std::string(int)> &nameOf);
+};
+
+#endif
@@ -6,8 +6,10 @@ using namespace std;
 void LabeledWeightedGraph::addWeightedEdge(int u, int v, time_t dateTime, double weight)
 {
     Graph::addEdge(u, v, dateTime);
-    //this->_edgeWeights.push_back(weight);  
-    _timeEdgeWeightMap[dateTime].push_back(weight);
+    _insertedWeights.push_back(weight);
+    // Edges added in order don't need to be sorted later
+    if(_edgesReady)
+        _edgeWeights.push_back(weight);
     
     // Make sure that labels are all accounted for
     if(max(u,v) >= _nodeLabels.size())
@@ -19,8 +21,9 @@ void LabeledWeightedGraph::addWeightedEdge(int u, int v, time_t dateTime, double
 void LabeledWeightedGraph::addEdge(int u, int v, time_t dateTime)
 {
     Graph::addEdge(u, v, dateTime);
-    //this->_edgeWeights.push_back(0.0);
-    _timeEdgeWeightMap[dateTime].push_back(0.0);
+    _insertedWeights.push_back(0.0);
+    if(_edgesReady)
+        _edgeWeights.push_back(0.0);
     
     // Make sure that labels are all accounted for
     if(max(u,v) >= _nodeLabels.size())
@@ -42,6 +45,18 @@ void LabeledWeightedGraph::copyEdge(int edgeIndex, const Graph& g)
         this->addLabeledNode(v, wg.getLabel(v));
 }
 
+void LabeledWeightedGraph::renumberNodes(const vector<int> &order)
+{
+    Graph::renumberNodes(order);
+    reorderNodeValues(_nodeLabels, order);
+    _nameMap.clear();
+    for(int v=0; v<_nodeLabels.size(); v++)
+    {
+        if(!_nodeLabels[v].empty())
+            _nameMap[_nodeLabels[v]] = v;
+    }
+}
+
 void LabeledWeightedGraph::addLabeledNode(int v, std::string label)
 {
     if(v < 0)
@@ -100,6 +115,7 @@ bool LabeledWeightedGraph::hasWeightRestrictions(int e) const
 
 void LabeledWeightedGraph::addWeightRestriction(int e, const WeightRestriction &restrict)
 {
+    this->checkNotFrozen();
     _weightRestricts[e].push_back(restrict);
 }
 
@@ -108,19 +124,21 @@ void LabeledWeightedGraph::updateOrderedEdges() const
     // Make sure base class is updated first
     Graph::updateOrderedEdges();
     
-    // Clear old edge weights
-    _edgeWeights.clear();
-    
-    // Build edge list in chronological order
-    for(auto &pair : _timeEdgeWeightMap)
-    {
-        time_t dateTime = pair.first;
-        const vector<double> &weights = _timeEdgeWeightMap.find(dateTime)->second;
-        for(double w : weights)
-        {
-            _edgeWeights.push_back(w);
-        }
-    }
+    // Put the weights of any edges that moved in chronological order
+    const vector<int> &order = this->insertionOrder();
+    int m = order.size();
+    _edgeWeights.resize(m);
+    for(int e=this->reorderStart(); e<m; e++)
+        _edgeWeights[e] = _insertedWeights[order[e]];
 }
 
 
+
+void LabeledWeightedGraph::removeOldestEdges(int count)
+{
+    Graph::removeOldestEdges(count);
+    _edgeWeights.erase(_edgeWeights.begin(), _edgeWeights.begin() + count);
+    // The remaining edges are renumbered in chronological order
+    _insertedWeights = _edgeWeights;
+    // (Weight restrictions are only used by query graphs, which aren't windowed)
+}
@@ -28,6 +28,8 @@ public:
     virtual void addWeightedEdge(int u, int v, time_t dateTime, double weight);
     /** Copies the given edge from another PajekGraph, including weight information. */
     virtual void copyEdge(int edgeIndex, const Graph &g) override;
+    /** Renumbers the nodes, moving their labels with them */
+    virtual void renumberNodes(const std::vector<int> &order) override;
     /** Creates a subgraph from the given set of nodes */
     //virtual Graph createSubGraph(const std::vector<int> &nodes) override;
     /** Gets the weight of the edge */
@@ -56,11 +58,14 @@ public:
 
 protected:
     virtual void updateOrderedEdges() const override;
+    virtual void removeOldestEdges(int count) override;
     
 private:
     std::vector<std::string> _nodeLabels;
     std::unordered_map<std::string,int> _nameMap;
-    std::map<time_t,std::vector<double>> _timeEdgeWeightMap;
+    // Weight of each edge, in the order they were added
+    std::vector<double> _insertedWeights;
+    // Weight of each edge, in chronological order
     mutable std::vector<double> _edgeWeights;
     std::unordered_map<int,std::vector<WeightRestriction>> _weightRestricts;
 };
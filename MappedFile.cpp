@@ -0,0 +1,43 @@
+#include "MappedFile.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace std;
+
+MappedFile::MappedFile(const string &fname)
+{
+    _fname = fname;
+    _data = NULL;
+    _size = 0;
+
+    int fd = open(fname.c_str(), O_RDONLY);
+    if(fd < 0)
+        throw "Unable to open file for memory mapping.";
+    struct stat st;
+    if(fstat(fd, &st) != 0)
+    {
+        close(fd);
+        throw "Unable to get the size of the file to memory map.";
+    }
+    _size = st.st_size;
+    if(_size > 0)
+    {
+        void *addr = mmap(NULL, _size, PROT_READ, MAP_SHARED, fd, 0);
+        if(addr == MAP_FAILED)
+        {
+            close(fd);
+            throw "Unable to memory map file.";
+        }
+        _data = (const char*)addr;
+    }
+    // The mapping stays valid after the file is closed
+    close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if(_data != NULL)
+        munmap((void*)_data, _size);
+}
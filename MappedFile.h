@@ -0,0 +1,33 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <stddef.h>
+#include <string>
+
+/**
+ * Read-only memory mapping of a whole file.  Pages are only read from disk
+ * when they're first touched, and since the mapping is shared, several
+ * processes mapping the same file use the same page-cached copy.
+ */
+class MappedFile
+{
+public:
+    /** Maps the given file, or throws an exception if it can't be opened. */
+    MappedFile(const std::string &fname);
+    ~MappedFile();
+    /** Start of the file's contents */
+    const char *data() const { return _data; }
+    /** Size of the file in bytes */
+    size_t size() const { return _size; }
+    /** Name of the mapped file */
+    const std::string &fname() const { return _fname; }
+private:
+    MappedFile(const MappedFile&) = delete;
+    MappedFile &operator=(const MappedFile&) = delete;
+
+    std::string _fname;
+    const char *_data;
+    size_t _size;
+};
+
+#endif
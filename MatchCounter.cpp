@@ -0,0 +1,87 @@
+#include "MatchCounter.h"
+#include <algorithm>
+
+using namespace std;
+
+MatchCounter::MatchCounter(const Graph &h, const MatchCriteria &criteria, int delta, bool countNodes)
+{
+    _h = &h;
+    _criteria = &criteria;
+    _delta = delta;
+    _countNodes = countNodes;
+    _count = 0;
+}
+
+int MatchCounter::update(const Graph &g)
+{
+    const EdgeList &edges = g.edges();
+    int m = edges.size();
+
+    // Find the first edge that hasn't been counted yet
+    int newEdge = _cursor.next(g);
+
+    int numFound = 0;
+    if(newEdge < m)
+    {
+        vector<GraphMatch> matches = _search.findNewOrderedSubgraphs(g, *_h, *_criteria, newEdge, INT_MAX, _delta);
+        for(const GraphMatch &match : matches)
+        {
+            int nodes = -1;
+            if(_countNodes)
+            {
+                // Reuse a free spot for the nodes, if there is one
+                int numNodes = _h->numNodes();
+                if(_freeNodes.empty())
+                {
+                    nodes = _matchNodes.size();
+                    _matchNodes.resize(nodes + numNodes, -1);
+                }
+                else
+                {
+                    nodes = _freeNodes.back();
+                    _freeNodes.pop_back();
+                }
+                // (the match lists the two nodes of each edge, so skip repeats)
+                int numAdded = 0;
+                for(int v : match.nodes())
+                {
+                    int *matchNodes = &_matchNodes[nodes];
+                    if(numAdded < numNodes && find(matchNodes, matchNodes + numAdded, v) == matchNodes + numAdded)
+                    {
+                        matchNodes[numAdded++] = v;
+                        _nodeCounts[v]++;
+                    }
+                }
+            }
+            _expiry.push(make_pair(edges[match.edges().front()].time(), nodes));
+        }
+        numFound = matches.size();
+        _count += numFound;
+    }
+    _cursor.advance(g);
+
+    if(g.windowDuration() > 0 && m > 0)
+        this->expire(g.windowStart());
+    return numFound;
+}
+
+void MatchCounter::expire(time_t windowStart)
+{
+    while(!_expiry.empty() && _expiry.top().first < windowStart)
+    {
+        int nodes = _expiry.top().second;
+        _expiry.pop();
+        _count--;
+        if(nodes < 0)
+            continue;
+        int numNodes = _h->numNodes();
+        for(int i=0; i<numNodes && _matchNodes[nodes+i] >= 0; i++)
+        {
+            int v = _matchNodes[nodes+i];
+            if(--_nodeCounts[v] == 0)
+                _nodeCounts.erase(v);
+            _matchNodes[nodes+i] = -1;
+        }
+        _freeNodes.push_back(nodes);
+    }
+}
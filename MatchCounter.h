@@ -0,0 +1,69 @@
+#ifndef MATCH_COUNTER_H
+#define MATCH_COUNTER_H
+
+#include "EdgeCursor.h"
+#include "Graph.h"
+#include "GraphSearch.h"
+#include "MatchCriteria.h"
+#include <stdint.h>
+#include <time.h>
+#include <limits.h>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * Keeps a live count of the ordered subgraphs matching a query, for a graph
+ * that keeps getting new edges (and whose window keeps moving forward).
+ * Each update() only searches for the matches that use the edges added since
+ * the last update, and removes the matches whose first edge has dropped out
+ * of the window.  Matches aren't stored, just their start times (in a queue
+ * ordered by time), so the work done is proportional to what changed.
+ *
+ * Edges are expected to arrive (roughly) in chronological order (see EdgeCursor).
+ */
+class MatchCounter
+{
+public:
+    /**
+     * @param h  The query graph (which must stay around as long as this does).
+     * @param criteria  Determines whether edges match (must also stay around).
+     * @param delta  The max time duration allowed between edge matches.
+     * @param countNodes  If true, also keeps the number of matches each node is in.
+     */
+    MatchCounter(const Graph &h, const MatchCriteria &criteria, int delta = INT_MAX, bool countNodes = false);
+    /**
+     * Adds the matches that use any edges added since the last update, and
+     * removes the ones that started before the graph's window.
+     * @return The number of new matches found.
+     */
+    int update(const Graph &g);
+    /** Number of matches in the current window */
+    int64_t count() const { return _count; }
+    /** Number of matches each node (in the data graph) is in, if countNodes
+     * was set.  Nodes that aren't in any matches are left out. */
+    const std::unordered_map<int,int> &nodeCounts() const { return _nodeCounts; }
+
+private:
+    /** Removes the matches that started before the given time */
+    void expire(time_t windowStart);
+
+    const Graph *_h;
+    const MatchCriteria *_criteria;
+    int _delta;
+    bool _countNodes;
+    GraphSearch _search;
+    int64_t _count;
+    std::unordered_map<int,int> _nodeCounts;
+    // Start time of each match, and where its nodes are in _matchNodes (or -1),
+    // with the earliest on top
+    std::priority_queue<std::pair<time_t,int>, std::vector<std::pair<time_t,int>>,
+                        std::greater<std::pair<time_t,int>>> _expiry;
+    // Nodes of each match (h->numNodes() for each), and the free spots
+    std::vector<int> _matchNodes, _freeNodes;
+    // Edges counted so far
+    EdgeCursor _cursor;
+};
+
+#endif
@@ -11,3 +11,28 @@ bool MatchCriteria::isNodeMatch(const Graph &g, int gNodeIndex, const Graph &h,
 {
     return true;
 }
+
+std::unique_ptr<MatchCriteria> MatchCriteria::prepare(const Graph &g, const Graph &h) const
+{
+    return std::unique_ptr<MatchCriteria>();
+}
+
+double MatchCriteria::estimateMatches(const GraphStats &stats, const Graph &h, int hEdgeIndex) const
+{
+    return -1;
+}
+
+const std::vector<int> &MatchCriteria::candidateOutEdges(const Graph &g, int gNodeIndex, const Graph &h, int hEdgeIndex) const
+{
+    return g.nodes()[gNodeIndex].outEdges();
+}
+
+const std::vector<int> &MatchCriteria::candidateInEdges(const Graph &g, int gNodeIndex, const Graph &h, int hEdgeIndex) const
+{
+    return g.nodes()[gNodeIndex].inEdges();
+}
+
+const std::vector<int> *MatchCriteria::candidateEdges(const Graph &g, const Graph &h, int hEdgeIndex) const
+{
+    return NULL;
+}
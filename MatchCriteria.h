@@ -9,6 +9,9 @@
 #define	EDGEMATCHCRITERIA_H
 
 #include "Graph.h"
+#include <memory>
+
+class GraphStats;
 
 /**
  * Base class allows users to define a criteria for whether or
@@ -19,6 +22,8 @@
 class MatchCriteria
 {
 public:
+    virtual ~MatchCriteria() {}
+
     /**
      * Pure virtual function returns true if there is a match between the
      * graph edge, and the criteria for the query edge.
@@ -40,6 +45,51 @@ public:
      * @return  True if the graph edge matches the criteria of the query edge.
      */
     virtual bool isNodeMatch(const Graph &g, int gNodeIndex, const Graph &h, int hNodeIndex) const;
+
+    /**
+     * Called once before a filter or search of g for h.  Returns a criteria
+     * to use in place of this one for it, which can precompute anything that
+     * doesn't change during it, or NULL to keep using this one (the default).
+     * The caller owns what's returned, and this criteria isn't changed, so it
+     * can be shared by searches in different threads.
+     * @param g  The graph we are searching.
+     * @param h  The query graph we are looking for.
+     * @return  The criteria to use for this filter or search, or NULL.
+     */
+    virtual std::unique_ptr<MatchCriteria> prepare(const Graph &g, const Graph &h) const;
+
+    /**
+     * Estimates how many edges of a graph match query edge hEdgeIndex from
+     * its catalog of statistics alone (see GraphStats), without looking at
+     * the edges.  Returns -1 if the catalog's counts don't cover anything
+     * the criteria tests (the default).
+     * @param stats  Statistics of the graph being searched (or the one it
+     * was filtered from).
+     * @param h  The query graph we are looking for.
+     * @param hEdgeIndex  The index of the edge in the query graph.
+     */
+    virtual double estimateMatches(const GraphStats &stats, const Graph &h, int hEdgeIndex) const;
+
+    /**
+     * Returns the out edges of node gNodeIndex that could possibly match query
+     * edge hEdgeIndex, as a chronologically sorted list of edge indexes.
+     * By default, this is all of the node's out edges.
+     */
+    virtual const std::vector<int> &candidateOutEdges(const Graph &g, int gNodeIndex, const Graph &h, int hEdgeIndex) const;
+
+    /**
+     * Returns the in edges of node gNodeIndex that could possibly match query
+     * edge hEdgeIndex, as a chronologically sorted list of edge indexes.
+     * By default, this is all of the node's in edges.
+     */
+    virtual const std::vector<int> &candidateInEdges(const Graph &g, int gNodeIndex, const Graph &h, int hEdgeIndex) const;
+
+    /**
+     * Returns a chronologically sorted list of the edges in g that could
+     * possibly match query edge hEdgeIndex, or NULL if it could be any edge
+     * (the default).
+     */
+    virtual const std::vector<int> *candidateEdges(const Graph &g, const Graph &h, int hEdgeIndex) const;
 };
 
 #endif	/* EDGEMATCHCRITERIA_H */
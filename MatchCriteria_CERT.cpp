@@ -1,5 +1,6 @@
 #include "MatchCriteria_CERT.h"
 #include "CertGraph.h"
+#include "Parallel.h"
 #include <iostream>
 
 using namespace std;
@@ -14,13 +15,10 @@ bool MatchCriteria_CERT::isEdgeMatch(const Graph& g, int gEdgeIndex, const Graph
     CertGraph &ch = (CertGraph&)h;
     
     // Check edge type first
-    const string &hEdgeType = ch.getEdgeType(hEdgeIndex);
-    //cout << "h edge type = " << hEdgeType << endl;
-    if(hEdgeType.empty() == false) // Only check if it's not empty in the search graph   
+    int hEdgeType = ch.getEdgeTypeId(hEdgeIndex);
+    if(hEdgeType != 0) // Only check if it's not empty in the search graph   
     {
-        const string &gEdgeType = cg.getEdgeType(gEdgeIndex);
-        //cout << "g edge type = " << gEdgeType << endl;
-        if(gEdgeType.compare(hEdgeType) != 0)
+        if(cg.getEdgeTypeId(gEdgeIndex) != hEdgeType)
             return false;
     }
         
@@ -59,11 +57,10 @@ bool MatchCriteria_CERT::isNodeMatch(const Graph &g, int gNodeIndex, const Graph
     }
     
     // Check node type
-    const string &hType = ch.getNodeType(hNodeIndex);
-    if(hType.empty() == false) // Only check if it's not empty in the search graph
+    int hType = ch.getNodeTypeId(hNodeIndex);
+    if(hType != 0) // Only check if it's not empty in the search graph
     {
-        const string &gType = cg.getNodeType(gNodeIndex);
-        if(gType.compare(hType) != 0)
+        if(cg.getNodeTypeId(gNodeIndex) != hType)
             return false;
     }
     
@@ -75,9 +72,9 @@ bool MatchCriteria_CERT::isNodeMatch(const Graph &g, int gNodeIndex, const Graph
         {
             int deg = 0;            
             if(restrict.isOutDeg())
-                deg = cg.getOutDeg(gNodeIndex, restrict.edgeType());         
+                deg = cg.getOutDeg(gNodeIndex, restrict.edgeTypeId());         
             else
-                deg = cg.getInDeg(gNodeIndex, restrict.edgeType());
+                deg = cg.getInDeg(gNodeIndex, restrict.edgeTypeId());
             if(restrict.isLessThan())
             {
                 //cout << gSource << " " << restrict.edgeType() << ": " << deg << " < " << restrict.value() << "?" << endl;
@@ -96,33 +93,46 @@ bool MatchCriteria_CERT::isNodeMatch(const Graph &g, int gNodeIndex, const Graph
     // Check regex restrictions
     if(ch.needsRegexMatch(hNodeIndex))
     {
-	const regex &rx = ch.getRegex(hNodeIndex);
-	if(regex_search(cg.getLabel(gNodeIndex), rx) == false)
+	const vector<uint64_t> *regexNodes = this->getRegexNodes(g, h, hNodeIndex);
+	if(regexNodes != NULL)
 	{
-	    //cout << cg.getLabel(gNodeIndex) << " doesn't match the regex" << endl;
-	    return false;
+	    if(((*regexNodes)[gNodeIndex >> 6] & (1ULL << (gNodeIndex & 63))) == 0)
+		return false;
+	}
+	else
+	{
+	    const regex &rx = ch.getRegex(hNodeIndex);
+	    if(regex_search(cg.getLabel(gNodeIndex), rx) == false)
+	    {
+		//cout << cg.getLabel(gNodeIndex) << " doesn't match the regex" << endl;
+		return false;
+	    }
 	}
     }
 
-    // Check adjacent out edge types    
-    const unordered_set<string> &gOutTypes = cg.getOutEdgeTypes(gNodeIndex);
-    const unordered_set<string> &hOutTypes = ch.getOutEdgeTypes(hNodeIndex);
-    for(const string &type : hOutTypes)
+    // Check adjacent out edge types (ignoring the blank type, bit 0)
+    const uint64_t OVERFLOW = 1ULL << TypeDictionary::OVERFLOW_BIT;
+    uint64_t hOutTypes = ch.getOutEdgeTypeMask(hNodeIndex) & ~1ULL;
+    if((hOutTypes & ~OVERFLOW & ~cg.getOutEdgeTypeMask(gNodeIndex)) != 0)
+        return false;
+    if(hOutTypes & OVERFLOW)
     {
-        if(!type.empty())
+        // Types sharing the overflow bit need their degree checked
+        for(int type : ch.getOutOverflowTypes(hNodeIndex))
         {
-            if(gOutTypes.find(type) == gOutTypes.end())
-                return false; 
+            if(cg.getOutDeg(gNodeIndex, type) == 0)
+                return false;
         }
     }
     // Check adjacent in edge types
-    const unordered_set<string> &gInTypes = cg.getInEdgeTypes(gNodeIndex);
-    const unordered_set<string> &hInTypes = ch.getInEdgeTypes(hNodeIndex);
-    for(const string &type : hInTypes)
+    uint64_t hInTypes = ch.getInEdgeTypeMask(hNodeIndex) & ~1ULL;
+    if((hInTypes & ~OVERFLOW & ~cg.getInEdgeTypeMask(gNodeIndex)) != 0)
+        return false;
+    if(hInTypes & OVERFLOW)
     {
-        if(!type.empty())
+        for(int type : ch.getInOverflowTypes(hNodeIndex))
         {
-            if(gInTypes.find(type) == gInTypes.end())
+            if(cg.getInDeg(gNodeIndex, type) == 0)
                 return false;
         }
     }
@@ -130,3 +140,97 @@ bool MatchCriteria_CERT::isNodeMatch(const Graph &g, int gNodeIndex, const Graph
     // If it pasts all tests, then it matches for our search
     return true;
 }
+
+unique_ptr<MatchCriteria> MatchCriteria_CERT::prepare(const Graph &g, const Graph &h) const
+{
+    CertGraph &cg = (CertGraph&)g;
+    CertGraph &ch = (CertGraph&)h;
+
+    unique_ptr<MatchCriteria_CERT> prepared;
+    // Regex result for each label already tested, for each expression
+    unordered_map<string,unordered_map<string,bool>> patternResults;
+    int n = g.numNodes();
+    for(int h_v=0; h_v<h.numNodes(); h_v++)
+    {
+	if(!ch.needsRegexMatch(h_v))
+	    continue;
+	if(!prepared)
+	{
+	    prepared.reset(new MatchCriteria_CERT(*this));
+	    prepared->_regexGraph = &g;
+	    prepared->_regexQuery = &h;
+	    prepared->_regexGraphNodes = n;
+	    prepared->_regexNodes.clear();
+	}
+	const regex &rx = ch.getRegex(h_v);
+	unordered_map<string,bool> &results = patternResults[ch.getRegexPattern(h_v)];
+
+	// Find the labels we haven't tested yet (only once for each label)
+	vector<const bool*> nodeResults(n);
+	vector<pair<const string,bool>*> untested;
+	for(int v=0; v<n; v++)
+	{
+	    auto inserted = results.emplace(cg.getLabel(v), false);
+	    if(inserted.second)
+		untested.push_back(&*inserted.first);
+	    nodeResults[v] = &inserted.first->second;
+	}
+
+	// Run the regular expression on them in parallel
+	Parallel::forRange(untested.size(), 1000, 1, [&](int begin, int end)
+	{
+	    for(int i=begin; i<end; i++)
+		untested[i]->second = regex_search(untested[i]->first, rx);
+	});
+
+	vector<uint64_t> &bits = prepared->_regexNodes[h_v];
+	bits.assign((n + 63) / 64, 0);
+	for(int v=0; v<n; v++)
+	{
+	    if(*nodeResults[v])
+		bits[v >> 6] |= 1ULL << (v & 63);
+	}
+    }
+    return move(prepared);
+}
+
+const vector<uint64_t> *MatchCriteria_CERT::getRegexNodes(const Graph &g, const Graph &h, int hNodeIndex) const
+{
+    // The graph could have grown since prepare() was called
+    if(&g != _regexGraph || &h != _regexQuery || g.numNodes() != _regexGraphNodes)
+	return NULL;
+    auto iter = _regexNodes.find(hNodeIndex);
+    if(iter == _regexNodes.end())
+	return NULL;
+    return &iter->second;
+}
+
+const vector<int> &MatchCriteria_CERT::candidateOutEdges(const Graph &g, int gNodeIndex, const Graph &h, int hEdgeIndex) const
+{
+    CertGraph &cg = (CertGraph&)g;
+    CertGraph &ch = (CertGraph&)h;
+    int type = ch.getEdgeTypeId(hEdgeIndex);
+    if(type == 0)
+	return MatchCriteria::candidateOutEdges(g, gNodeIndex, h, hEdgeIndex);
+    return cg.getTypedOutEdges(gNodeIndex, type);
+}
+
+const vector<int> &MatchCriteria_CERT::candidateInEdges(const Graph &g, int gNodeIndex, const Graph &h, int hEdgeIndex) const
+{
+    CertGraph &cg = (CertGraph&)g;
+    CertGraph &ch = (CertGraph&)h;
+    int type = ch.getEdgeTypeId(hEdgeIndex);
+    if(type == 0)
+	return MatchCriteria::candidateInEdges(g, gNodeIndex, h, hEdgeIndex);
+    return cg.getTypedInEdges(gNodeIndex, type);
+}
+
+const vector<int> *MatchCriteria_CERT::candidateEdges(const Graph &g, const Graph &h, int hEdgeIndex) const
+{
+    CertGraph &cg = (CertGraph&)g;
+    CertGraph &ch = (CertGraph&)h;
+    int type = ch.getEdgeTypeId(hEdgeIndex);
+    if(type == 0)
+	return MatchCriteria::candidateEdges(g, h, hEdgeIndex);
+    return &cg.getTypedEdges(type);
+}
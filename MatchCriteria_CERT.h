@@ -10,6 +10,10 @@
 
 #include "Graph.h"
 #include "MatchCriteria.h"
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
 
 /**
  * Criteria for CERT graphs, whether or not the edge or node 
@@ -41,6 +45,36 @@ public:
      * @return  True if the graph edge matches the criteria of the query edge.
      */
     virtual bool isNodeMatch(const Graph &g, int gNodeIndex, const Graph &h, int hNodeIndex) const override;
+
+    /**
+     * Evaluates the regular expression restrictions of the query nodes
+     * against the node labels of g, and returns a copy of this criteria that
+     * keeps the nodes that match as a bitset, so its isNodeMatch doesn't need
+     * to run the regular expressions.  Each distinct label is only tested once
+     * per distinct expression.  Returns NULL if h has no regex restrictions.
+     * @param g  The graph we are searching.
+     * @param h  The query graph we are looking for.
+     */
+    virtual std::unique_ptr<MatchCriteria> prepare(const Graph &g, const Graph &h) const override;
+
+    /** Returns only the node's out edges with the query edge's type, if it has one. */
+    virtual const std::vector<int> &candidateOutEdges(const Graph &g, int gNodeIndex, const Graph &h, int hEdgeIndex) const override;
+    /** Returns only the node's in edges with the query edge's type, if it has one. */
+    virtual const std::vector<int> &candidateInEdges(const Graph &g, int gNodeIndex, const Graph &h, int hEdgeIndex) const override;
+    /** Returns only the edges with the query edge's type, if it has one. */
+    virtual const std::vector<int> *candidateEdges(const Graph &g, const Graph &h, int hEdgeIndex) const override;
+
+private:
+    /** Returns the bitset of nodes in g matching the regex for the query node,
+     * or NULL if this criteria wasn't prepared for these graphs. */
+    const std::vector<uint64_t> *getRegexNodes(const Graph &g, const Graph &h, int hNodeIndex) const;
+
+    // Graphs the regex bitsets were computed for (set by prepare())
+    const Graph *_regexGraph = NULL;
+    const Graph *_regexQuery = NULL;
+    int _regexGraphNodes = 0;
+    // Nodes of g matching the regex of each query node
+    std::unordered_map<int,std::vector<uint64_t>> _regexNodes;
 };
 
 #endif	/* EDGEMATCHCRITERIA_CERT_H */
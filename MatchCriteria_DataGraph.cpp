@@ -1,5 +1,6 @@
 #include "MatchCriteria_DataGraph.h"
 #include "DataGraph.h"
+#include "GraphStats.h"
 #include <iostream>
 
 using namespace std;
@@ -14,7 +15,7 @@ bool MatchCriteria_DataGraph::isEdgeMatch(const Graph& g, int gEdgeIndex, const
     DataGraph &dh = (DataGraph&)h;
     
     // Check edge attributes first
-    if(this->doAttributesMatch(dg.edgeAttributes()[gEdgeIndex], dh.edgeAttributes()[hEdgeIndex]) == false)
+    if(this->doColumnsMatch(dg.edgeColumns(), gEdgeIndex, dh.edgeColumns(), hEdgeIndex) == false)
         return false;
         
     const Edge &hEdge = dh.edges()[hEdgeIndex];
@@ -45,7 +46,7 @@ bool MatchCriteria_DataGraph::isNodeMatch(const Graph &g, int gNodeIndex, const
     DataGraph &dh = (DataGraph&)h;
     
     // Check node attributes first
-    if(this->doAttributesMatch(dg.nodeAttributes()[gNodeIndex], dh.nodeAttributes()[hNodeIndex]) == false)
+    if(this->doColumnsMatch(dg.nodeColumns(), gNodeIndex, dh.nodeColumns(), hNodeIndex) == false)
         return false;
 
     // TODO: May want to also look at adjacent edges, like we do
@@ -55,6 +56,35 @@ bool MatchCriteria_DataGraph::isNodeMatch(const Graph &g, int gNodeIndex, const
     return true;
 }
 
+double MatchCriteria_DataGraph::estimateMatches(const GraphStats &stats, const Graph &h, int hEdgeIndex) const
+{
+    DataGraph &dh = (DataGraph&)h;
+    if(stats.numEdges <= 0)
+        return -1;
+
+    // Same VARCHAR attributes the catalog counts the values of
+    const AttributesDef &edgeDef = dh.edgeAttributesDef();
+    const AttributeColumns &hColumns = dh.edgeColumns();
+    double numMatches = stats.numEdges;
+    bool isCounted = false;
+    for(int i=0, k=0; i<edgeDef.attributeNames().size(); i++)
+    {
+        if(edgeDef.attributeTypes()[i] != DATA || edgeDef.dataTypes()[i] != STRING)
+            continue;
+        const StringRestrictions &r = hColumns.stringRestriction(k, hEdgeIndex);
+        auto valueCounts = stats.edgeValueCounts.find(edgeDef.attributeNames()[i]);
+        if(!r.any() && r.exact() && valueCounts != stats.edgeValueCounts.end())
+        {
+            auto count = valueCounts->second.find(hColumns.stringAt(k, hEdgeIndex));
+            int64_t numWithValue = count == valueCounts->second.end() ? 0 : count->second;
+            numMatches *= (double)numWithValue / stats.numEdges;
+            isCounted = true;
+        }
+        k++;
+    }
+    return isCounted ? numMatches : -1;
+}
+
 bool MatchCriteria_DataGraph::doAttributesMatch(const Attributes& a1, const Attributes& a2) const
 {
     if(a1.floatValues().size() != a2.floatValues().size() ||
@@ -116,3 +146,52 @@ bool MatchCriteria_DataGraph::doAttributesMatch(const Attributes& a1, const Attr
     }
     return true;
 }
+
+bool MatchCriteria_DataGraph::doColumnsMatch(const AttributeColumns &c1, int row1, const AttributeColumns &c2, int row2) const
+{
+    if(c1.numFloatColumns() != c2.numFloatColumns() ||
+       c1.numIntColumns() != c2.numIntColumns() ||
+       c1.numStringColumns() != c2.numStringColumns())
+    {
+        throw "Can't compare attributes. Number of attributes of each type don't match!";
+    }
+
+    for(int k=0; k<c1.numFloatColumns(); k++)
+    {
+        const FloatRestrictions &r2 = c2.floatRestriction(k, row2);
+        if(r2.any())
+            continue;
+        float x1 = c1.floatColumn(k)[row1], x2 = c2.floatColumn(k)[row2];
+        if(r2.hasMin() && x1 < r2.min())
+            return false;
+        if(r2.hasMax() && x1 > r2.max())
+            return false;
+        if(r2.exact() && x1 != x2)
+            return false;
+    }
+
+    for(int k=0; k<c1.numIntColumns(); k++)
+    {
+        const IntRestrictions &r2 = c2.intRestriction(k, row2);
+        if(r2.any())
+            continue;
+        int x1 = c1.intColumn(k)[row1], x2 = c2.intColumn(k)[row2];
+        if(r2.hasMin() && x1 < r2.min())
+            return false;
+        if(r2.hasMax() && x1 > r2.max())
+            return false;
+        if(r2.exact() && x1 != x2)
+            return false;
+    }
+
+    for(int k=0; k<c1.numStringColumns(); k++)
+    {
+        const StringRestrictions &r2 = c2.stringRestriction(k, row2);
+        if(r2.any())
+            continue;
+        // The two graphs have their own dictionaries, so compare the strings
+        if(r2.exact() && c1.stringAt(k, row1) != c2.stringAt(k, row2))
+            return false;
+    }
+    return true;
+}
@@ -1,6 +1,7 @@
 #ifndef MATCH_CRITERIA_DATA_GRAPH_H
 #define MATCH_CRITERIA_DATA_GRAPH_H
 
+#include "AttributeColumns.h"
 #include "Attributes.h"
 #include "DataGraph.h"
 #include "Graph.h"
@@ -37,10 +38,25 @@ public:
      */
     virtual bool isNodeMatch(const Graph &g, int gNodeIndex, const Graph &h, int hNodeIndex) const override;
     
+    /**
+     * Estimates the edges that match from the catalog's count of edges with
+     * each value of the VARCHAR attributes the query edge needs an exact
+     * value for (assuming they're independent).  The other attributes and
+     * the nodes aren't counted by the catalog, so returns -1 if there are
+     * no such values.
+     */
+    virtual double estimateMatches(const GraphStats &stats, const Graph &h, int hEdgeIndex) const override;
+
     /**
      * Returns true if the attributes match.
      */
     virtual bool doAttributesMatch(const Attributes &a1, const Attributes &a2) const;
+
+    /**
+     * Same as doAttributesMatch(), but reads the values straight from the 
+     * attribute columns of the two graphs (row1 of c1 against row2 of c2).
+     */
+    bool doColumnsMatch(const AttributeColumns &c1, int row1, const AttributeColumns &c2, int row2) const;
 };
 
 
@@ -0,0 +1,127 @@
+#include "NodeNames.h"
+#include <string.h>
+
+using namespace std;
+
+NodeNames::NodeNames()
+{
+    _numViewNames = 0;
+    _viewOffsets = NULL;
+    _viewChars = NULL;
+    _viewIndex = NULL;
+    _viewIndexSize = 0;
+}
+
+string NodeNames::get(int v) const
+{
+    if(v < _numViewNames)
+        return string(_viewChars + _viewOffsets[v], _viewOffsets[v+1] - _viewOffsets[v]);
+    return _names[v - _numViewNames];
+}
+
+int NodeNames::find(const string &name) const
+{
+    // Names added later take priority
+    auto iter = _nameMap.find(name);
+    if(iter != _nameMap.end())
+        return iter->second;
+    return this->findView(name);
+}
+
+int NodeNames::findView(const string &name) const
+{
+    if(_viewIndexSize == 0)
+        return -1;
+    uint64_t mask = _viewIndexSize - 1;
+    for(uint64_t slot = hash(name.data(), name.size()) & mask; ; slot = (slot + 1) & mask)
+    {
+        int v = _viewIndex[slot];
+        if(v < 0)
+            return -1;
+        size_t len = _viewOffsets[v+1] - _viewOffsets[v];
+        if(len == name.size() && memcmp(_viewChars + _viewOffsets[v], name.data(), len) == 0)
+            return v;
+    }
+}
+
+int NodeNames::add(const string &name)
+{
+    int v = this->size();
+    _names.push_back(name);
+    _nameMap[name] = v;
+    return v;
+}
+
+void NodeNames::resize(int n)
+{
+    if(n > this->size())
+        _names.resize(n - _numViewNames);
+}
+
+void NodeNames::set(int v, const string &name)
+{
+    if(v < _numViewNames)
+        throw "Can't rename nodes loaded from a snapshot.";
+    _names[v - _numViewNames] = name;
+    _nameMap[name] = v;
+}
+
+void NodeNames::remove(int v)
+{
+    if(v < _numViewNames)
+        throw "Can't remove nodes loaded from a snapshot.";
+    string &name = _names[v - _numViewNames];
+    auto iter = _nameMap.find(name);
+    if(iter != _nameMap.end() && iter->second == v)
+        _nameMap.erase(iter);
+    name.clear();
+}
+
+void NodeNames::setView(shared_ptr<MappedFile> file, int n, const int64_t *offsets, const char *chars,
+                        const int32_t *index, int64_t indexSize)
+{
+    _file = file;
+    _numViewNames = n;
+    _viewOffsets = offsets;
+    _viewChars = chars;
+    _viewIndex = index;
+    _viewIndexSize = indexSize;
+    _names.clear();
+    _nameMap.clear();
+}
+
+vector<int32_t> NodeNames::createIndex() const
+{
+    int n = this->size();
+    uint64_t size = 1;
+    while(size < 2 * (uint64_t)n)
+        size *= 2;
+    vector<int32_t> index(size, -1);
+    uint64_t mask = size - 1;
+    for(int v=0; v<n; v++)
+    {
+        string name = this->get(v);
+        for(uint64_t slot = hash(name.data(), name.size()) & mask; ; slot = (slot + 1) & mask)
+        {
+            // Duplicate names point to the last node with the name (like find())
+            if(index[slot] < 0 || this->get(index[slot]) == name)
+            {
+                index[slot] = v;
+                break;
+            }
+        }
+    }
+    return index;
+}
+
+uint64_t NodeNames::hash(const char *str, size_t len)
+{
+    // FNV-1a
+    uint64_t h = 14695981039346656037ULL;
+    for(size_t i=0; i<len; i++)
+    {
+        h ^= (unsigned char)str[i];
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
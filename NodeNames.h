@@ -0,0 +1,73 @@
+#ifndef NODE_NAMES_H
+#define NODE_NAMES_H
+
+#include "MappedFile.h"
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * Names of the nodes in a graph, and an index for finding a node by its name.
+ * 
+ * The names can start out as a read-only view into a snapshot file (see 
+ * FileIO::loadSnapshot()), where both the names and a hash table index of 
+ * them are used directly from the mapped file.  Nodes added afterwards are
+ * stored in regular vectors/maps.
+ */
+class NodeNames
+{
+public:
+    NodeNames();
+    /** Number of named nodes */
+    int size() const { return _numViewNames + _names.size(); }
+    /** Name of the given node */
+    std::string get(int v) const;
+    /** Index of the node with the given name, or -1 if there isn't one.
+     * (If several nodes share a name, the last one added is returned.) */
+    int find(const std::string &name) const;
+    /** Adds a node with the given name, returning its index. */
+    int add(const std::string &name);
+    /** Makes sure there are at least n nodes (added with blank names). */
+    void resize(int n);
+    /** Renames the given node. */
+    void set(int v, const std::string &name);
+    /** Blanks out the given node's name, so find() doesn't return it anymore. */
+    void remove(int v);
+
+    /**
+     * Uses names stored in a mapped file, replacing any existing names.
+     * @param file  File the data is in (kept open as long as the names are used).
+     * @param n  Number of names.
+     * @param offsets  n+1 offsets into chars, where each name starts.
+     * @param chars  Characters of all the names.
+     * @param index  Hash table from createIndex().
+     * @param indexSize  Number of entries in the hash table (a power of 2).
+     */
+    void setView(std::shared_ptr<MappedFile> file, int n, const int64_t *offsets, const char *chars,
+                 const int32_t *index, int64_t indexSize);
+    /** Creates an open addressing hash table of the node names (-1 for empty slots),
+     * to be stored along with them. */
+    std::vector<int32_t> createIndex() const;
+
+    /** Hash function used for the index */
+    static uint64_t hash(const char *str, size_t len);
+
+private:
+    /** Index of the name in the view's hash table, or -1 */
+    int findView(const std::string &name) const;
+
+    // Names in the mapped file
+    std::shared_ptr<MappedFile> _file;
+    int _numViewNames;
+    const int64_t *_viewOffsets;
+    const char *_viewChars;
+    const int32_t *_viewIndex;
+    int64_t _viewIndexSize;
+    // Names added normally (after any in the view)
+    std::vector<std::string> _names;
+    std::unordered_map<std::string,int> _nameMap;
+};
+
+#endif
@@ -0,0 +1,155 @@
+#include "NodeOrder.h"
+#include <algorithm>
+
+using namespace std;
+
+namespace
+{
+    /** Nodes in the order their first edge happened (nodes without edges go last) */
+    vector<int> firstActivityOrder(const Graph &g)
+    {
+        int n = g.numNodes();
+        vector<int> order;
+        order.reserve(n);
+        vector<bool> isAdded(n, false);
+        const EdgeList &edges = g.edges();
+        const EdgeNodes *nodes = edges.nodes();
+        for(int e=0; e<edges.size(); e++)
+        {
+            for(int v : {nodes[e].source, nodes[e].dest})
+            {
+                if(!isAdded[v])
+                {
+                    isAdded[v] = true;
+                    order.push_back(v);
+                }
+            }
+        }
+        for(int v=0; v<n; v++)
+        {
+            if(!isAdded[v])
+                order.push_back(v);
+        }
+        return order;
+    }
+
+    /**
+     * Reverse Cuthill-McKee: a breadth first search of each component
+     * (ignoring edge direction), starting from its lowest degree node and
+     * visiting each node's neighbours from lowest to highest degree, with
+     * the whole order reversed at the end.
+     */
+    vector<int> rcmOrder(const Graph &g)
+    {
+        // (getting the edges merges in any that are pending, so the
+        // adjacency lists are complete)
+        const EdgeList &edges = g.edges();
+        int n = g.numNodes();
+        const vector<Node> &nodes = g.nodes();
+        auto degree = [&nodes](int v) { return nodes[v].edges().size(); };
+        auto byDegree = [&degree](int a, int b) { return degree(a) < degree(b); };
+
+        vector<int> starts(n);
+        for(int v=0; v<n; v++)
+            starts[v] = v;
+        stable_sort(starts.begin(), starts.end(), byDegree);
+
+        vector<int> order;
+        order.reserve(n);
+        vector<bool> isVisited(n, false);
+        vector<int> neighbours;
+        for(int start : starts)
+        {
+            if(isVisited[start])
+                continue;
+            isVisited[start] = true;
+            order.push_back(start);
+
+            // (the order doubles as the queue)
+            for(int next=order.size()-1; next<order.size(); next++)
+            {
+                int u = order[next];
+                neighbours.clear();
+                for(int e : nodes[u].edges())
+                {
+                    int v = edges.source(e) == u ? edges.dest(e) : edges.source(e);
+                    if(!isVisited[v])
+                    {
+                        isVisited[v] = true;
+                        neighbours.push_back(v);
+                    }
+                }
+                stable_sort(neighbours.begin(), neighbours.end(), byDegree);
+                order.insert(order.end(), neighbours.begin(), neighbours.end());
+            }
+        }
+        reverse(order.begin(), order.end());
+        return order;
+    }
+
+    /** Nodes from highest to lowest degree */
+    vector<int> degreeOrder(const Graph &g)
+    {
+        g.edges();
+        int n = g.numNodes();
+        const vector<Node> &nodes = g.nodes();
+        vector<int> order(n);
+        for(int v=0; v<n; v++)
+            order[v] = v;
+        stable_sort(order.begin(), order.end(), [&nodes](int a, int b)
+        {
+            return nodes[a].edges().size() > nodes[b].edges().size();
+        });
+        return order;
+    }
+}
+
+NodeOrder::Strategy NodeOrder::parse(const string &name)
+{
+    for(Strategy strategy : NodeOrder::all())
+    {
+        if(name == NodeOrder::name(strategy))
+            return strategy;
+    }
+    throw "Unknown node order (it has to be original, first-activity, rcm or degree).";
+}
+
+string NodeOrder::name(Strategy strategy)
+{
+    switch(strategy)
+    {
+    case FIRST_ACTIVITY:
+        return "first-activity";
+    case RCM:
+        return "rcm";
+    case DEGREE:
+        return "degree";
+    default:
+        return "original";
+    }
+}
+
+vector<NodeOrder::Strategy> NodeOrder::all()
+{
+    return { ORIGINAL, FIRST_ACTIVITY, RCM, DEGREE };
+}
+
+vector<int> NodeOrder::compute(const Graph &g, Strategy strategy)
+{
+    switch(strategy)
+    {
+    case FIRST_ACTIVITY:
+        return firstActivityOrder(g);
+    case RCM:
+        return rcmOrder(g);
+    case DEGREE:
+        return degreeOrder(g);
+    default:
+    {
+        vector<int> order(g.numNodes());
+        for(int v=0; v<order.size(); v++)
+            order[v] = v;
+        return order;
+    }
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef NODE_ORDER_H
+#define NODE_ORDER_H
+
+#include "Graph.h"
+#include <string>
+#include <vector>
+
+/**
+ * Orders for renumbering a graph's nodes (see Graph::renumberNodes()), so
+ * nodes that are used together end up close together in memory.  The
+ * search looks up the nodes of each edge it tests, and the edges are in
+ * time order, so with the nodes in the order they were loaded in, those
+ * lookups jump all over the node arrays.
+ *
+ * FIRST_ACTIVITY numbers the nodes in the order their first edge happened,
+ * RCM (reverse Cuthill-McKee) numbers them breadth first from a low degree
+ * node of each component, so neighbours are close together, and DEGREE puts
+ * the busiest nodes (the hubs most edges touch) first.
+ */
+class NodeOrder
+{
+public:
+    enum Strategy { ORIGINAL, FIRST_ACTIVITY, RCM, DEGREE };
+
+    /** Strategy with the given name ("original", "first-activity", "rcm" or "degree") */
+    static Strategy parse(const std::string &name);
+    static std::string name(Strategy strategy);
+    /** Every strategy, starting with ORIGINAL */
+    static std::vector<Strategy> all();
+
+    /**
+     * Computes the new order of g's nodes.
+     * @return  Every node, in its new order (to pass to Graph::renumberNodes()).
+     */
+    static std::vector<int> compute(const Graph &g, Strategy strategy);
+};
+
+#endif
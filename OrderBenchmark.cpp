@@ -0,0 +1,127 @@
+#include "OrderBenchmark.h"
+#include "FileIO.h"
+#include "GraphFilter.h"
+#include "GraphSearch.h"
+#include "MatchCriteria_DataGraph.h"
+#include "NodeOrder.h"
+#include <limits.h>
+#include <stdint.h>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+namespace
+{
+    /** Counts the CPU's cache misses (for this thread), if the counter can be opened */
+    class CacheMissCounter
+    {
+    public:
+        CacheMissCounter() : _fd(-1)
+        {
+#ifdef __linux__
+            perf_event_attr attr = perf_event_attr();
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HARDWARE;
+            attr.config = PERF_COUNT_HW_CACHE_MISSES;
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            _fd = syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+#endif
+        }
+        ~CacheMissCounter()
+        {
+#ifdef __linux__
+            if(_fd >= 0)
+                close(_fd);
+#endif
+        }
+        bool isAvailable() const { return _fd >= 0; }
+        void start()
+        {
+#ifdef __linux__
+            if(_fd >= 0)
+            {
+                ioctl(_fd, PERF_EVENT_IOC_RESET, 0);
+                ioctl(_fd, PERF_EVENT_IOC_ENABLE, 0);
+            }
+#endif
+        }
+        /** Cache misses since start() (or -1 if they can't be counted) */
+        int64_t stop()
+        {
+            int64_t count = -1;
+#ifdef __linux__
+            if(_fd >= 0)
+            {
+                ioctl(_fd, PERF_EVENT_IOC_DISABLE, 0);
+                if(read(_fd, &count, sizeof(count)) != sizeof(count))
+                    count = -1;
+            }
+#endif
+            return count;
+        }
+    private:
+        int _fd;
+    };
+}
+
+void OrderBenchmark::run(const DataGraph &g, const vector<string> &queryFnames, const vector<time_t> &deltaValues)
+{
+    vector<DataGraph> queries;
+    for(const string &queryFname : queryFnames)
+        queries.push_back(FileIO::loadGenericGDF(queryFname));
+
+    // (the filter prints as it goes, so the table is printed at the end)
+    CacheMissCounter counter;
+    stringstream table;
+    table << "Order           Reorder (s)  Search (s)  Cache misses  Matches" << endl;
+    for(NodeOrder::Strategy strategy : NodeOrder::all())
+    {
+        cout << "Searching with the nodes in " << NodeOrder::name(strategy) << " order" << endl;
+        auto reorderStart = chrono::steady_clock::now();
+        DataGraph g1 = g;
+        g1.renumberNodes(NodeOrder::compute(g1, strategy));
+        chrono::duration<double> reorderTime = chrono::steady_clock::now() - reorderStart;
+
+        // Filter and search, like a normal search does
+        int64_t numMatches = 0;
+        auto searchStart = chrono::steady_clock::now();
+        counter.start();
+        for(const DataGraph &h : queries)
+        {
+            MatchCriteria_DataGraph criteria;
+            DataGraph g2;
+            g2.setNodeAttributesDef(g1.nodeAttributesDef());
+            g2.setEdgeAttributesDef(g1.edgeAttributesDef());
+            GraphFilter::filter(g1, h, criteria, g2);
+            for(time_t delta : deltaValues)
+            {
+                GraphSearch search;
+                numMatches += search.findOrderedSubgraphs(g2, h, criteria, INT_MAX, delta).size();
+            }
+        }
+        int64_t cacheMisses = counter.stop();
+        chrono::duration<double> searchTime = chrono::steady_clock::now() - searchStart;
+
+        table << left << setw(16) << NodeOrder::name(strategy) << right << fixed << setprecision(3);
+        table << setw(11) << reorderTime.count() << setw(12) << searchTime.count();
+        if(cacheMisses >= 0)
+            table << setw(14) << cacheMisses;
+        else
+            table << setw(14) << "n/a";
+        table << setw(9) << numMatches << endl;
+    }
+    cout << endl << table.str();
+    if(!counter.isAvailable())
+        cout << "(cache misses can't be counted here, so they're shown as n/a)" << endl;
+}
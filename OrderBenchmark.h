@@ -0,0 +1,22 @@
+#ifndef ORDER_BENCHMARK_H
+#define ORDER_BENCHMARK_H
+
+#include "DataGraph.h"
+#include <time.h>
+#include <string>
+#include <vector>
+
+/**
+ * Measures how each node order (see NodeOrder) affects the search: for each
+ * one, it renumbers a copy of the data graph, then filters it and searches
+ * for each query and delta, and prints the time taken, the CPU cache misses
+ * (when the hardware counters can be read, on Linux), and the number of
+ * matches (which should be the same for every order).
+ */
+class OrderBenchmark
+{
+public:
+    static void run(const DataGraph &g, const std::vector<std::string> &queryFnames, const std::vector<time_t> &deltaValues);
+};
+
+#endif
@@ -0,0 +1,33 @@
+#include "Parallel.h"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+int Parallel::numThreads()
+{
+    int n = thread::hardware_concurrency();
+    return n > 0 ? n : 1;
+}
+
+void Parallel::forRange(int n, int minPerThread, int align, const function<void(int,int)> &fn)
+{
+    int numThreads = min(Parallel::numThreads(), max(1, n / max(1, minPerThread)));
+    if(numThreads <= 1)
+    {
+        fn(0, n);
+        return;
+    }
+
+    // Round the chunk size up to the alignment
+    int chunk = (n + numThreads - 1) / numThreads;
+    chunk = ((chunk + align - 1) / align) * align;
+    vector<thread> threads;
+    for(int begin=chunk; begin<n; begin+=chunk)
+        threads.push_back(thread(fn, begin, min(n, begin + chunk)));
+    // The calling thread does the first chunk itself
+    fn(0, min(n, chunk));
+    for(thread &t : threads)
+        t.join();
+}
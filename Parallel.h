@@ -0,0 +1,27 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <functional>
+
+/**
+ * Simple helper for splitting a loop over several threads.
+ */
+class Parallel
+{
+public:
+    /** Number of threads to use (the number of hardware threads, at least 1) */
+    static int numThreads();
+    /**
+     * Calls fn(begin, end) on contiguous chunks covering [0, n), each chunk on
+     * its own thread, and waits for all of them to finish.  Small ranges are
+     * run on the calling thread.
+     * @param n  Number of items in the loop.
+     * @param minPerThread  Minimum number of items worth starting a thread for.
+     * @param align  Chunk boundaries are multiples of this (e.g., 64 so that
+     *               threads writing to a bitset never share a word).
+     * @param fn  Function called with the range of items to process.
+     */
+    static void forRange(int n, int minPerThread, int align, const std::function<void(int,int)> &fn);
+};
+
+#endif
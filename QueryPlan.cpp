@@ -0,0 +1,243 @@
+#include "QueryPlan.h"
+#include "GraphStats.h"
+#include <math.h>
+#include <algorithm>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+using namespace std;
+
+namespace
+{
+    /** Formats an estimated count: rounded if it fits in an int64_t
+     * (with room to spare), otherwise in scientific notation. */
+    string formatCount(double x)
+    {
+        stringstream ss;
+        if(fabs(x) < 1e15)
+            ss << llround(x);
+        else
+            ss << setprecision(3) << x;
+        return ss.str();
+    }
+
+    /** Estimated number of edges in g (from startEdge on) that match query edge h_i */
+    double estimateCandidates(const Graph &g, const Graph &h, const MatchCriteria &criteria, int h_i, int startEdge)
+    {
+        // The criteria's list, if it has one, is more or less exact
+        int m = g.numEdges();
+        const vector<int> *searchEdges = criteria.candidateEdges(g, h, h_i);
+        if(searchEdges != NULL)
+            return searchEdges->end() - lower_bound(searchEdges->begin(), searchEdges->end(), startEdge);
+
+        // Then the catalog's counts, if it has them for what the criteria
+        // tests.  They're for all of g's edges (or the graph it was filtered
+        // from, which only leaves out edges that can't match), so they're
+        // spread over the edges being searched.
+        int range = m - startEdge;
+        const GraphStats *graphStats = g.stats();
+        int numGraphEdges = m - g.firstEdge();
+        if(graphStats != NULL && graphStats->numEdges >= numGraphEdges && range > 0)
+        {
+            double numMatches = criteria.estimateMatches(*graphStats, h, h_i);
+            if(numMatches >= 0)
+                return min((double)range, numMatches * range / numGraphEdges);
+        }
+
+        // Otherwise, test a sample of the edges (spread out over time)
+        const int MAX_SAMPLES = 1024;
+        int numSamples = min(range, MAX_SAMPLES);
+        if(numSamples <= 0)
+            return 0;
+        const Edge &hEdge = h.edges()[h_i];
+        bool isSelfLoop = hEdge.source() == hEdge.dest();
+        int numMatches = 0;
+        for(int i=0; i<numSamples; i++)
+        {
+            int e = startEdge + (int)((int64_t)i * range / numSamples);
+            const Edge &gEdge = g.edges()[e];
+            if((gEdge.source() == gEdge.dest()) == isSelfLoop && criteria.isEdgeMatch(g, e, h, h_i))
+                numMatches++;
+        }
+        return (double)numMatches * range / numSamples;
+    }
+
+    /** Numbers about the part of the graph being searched */
+    struct SearchStats
+    {
+        // Nodes, edges searched, edges within delta of each other, and edges per node within delta
+        double numNodes, numEdges, windowEdges, windowDegree;
+        vector<double> numCandidates;
+        vector<bool> isTyped;
+    };
+
+    /**
+     * Estimates the cost of matching the query edges in the given order.
+     * Starting from the edges that match the first one, each query edge
+     * multiplies the number of partial matches by the number of edges that
+     * can extend them: the matching out/in edges of a node that's already
+     * mapped (within delta), or any matching edge within delta, if neither
+     * of its nodes are.  The cost is the number of edges tested.
+     */
+    double estimateCost(const Graph &h, const SearchStats &stats, const vector<int> &order, bool isAnchored,
+                        vector<double> &estMatches, vector<string> &access)
+    {
+        int numQueryEdges = order.size();
+        estMatches.assign(numQueryEdges, 0);
+        access.assign(numQueryEdges, "");
+        vector<bool> isMapped(h.numNodes(), false);
+
+        double cost = 0, numPartials = 0;
+        for(int s=0; s<numQueryEdges; s++)
+        {
+            int h_i = order[s];
+            const Edge &hEdge = h.edges()[h_i];
+            double numCandidates = stats.numCandidates[h_i];
+            double selectivity = stats.numEdges > 0 ? numCandidates / stats.numEdges : 0;
+            bool isTyped = stats.isTyped[h_i];
+            bool uMapped = isMapped[hEdge.source()], vMapped = isMapped[hEdge.dest()];
+
+            if(s == 0)
+            {
+                // Every edge (or every one in the criteria's list) is a possible start
+                cost += isTyped ? numCandidates : stats.numEdges;
+                numPartials = numCandidates;
+                access[h_i] = isTyped ? "typed list" : "scan";
+            }
+            else
+            {
+                // (only about half the edges within delta are on the right side in time)
+                double tested, numExtensions;
+                if(uMapped || vMapped)
+                {
+                    tested = isTyped ? stats.windowDegree * selectivity : stats.windowDegree;
+                    numExtensions = stats.windowDegree * selectivity / 2;
+                    if(uMapped && vMapped)
+                    {
+                        // The other node has to match too
+                        numExtensions /= max(1.0, min(stats.windowDegree, stats.numNodes));
+                        access[h_i] = isTyped ? "typed out/in list" : "out/in list";
+                    }
+                    else if(uMapped)
+                        access[h_i] = isTyped ? "typed out list" : "out list";
+                    else
+                        access[h_i] = isTyped ? "typed in list" : "in list";
+                }
+                else
+                {
+                    // The normal search keeps a list of the edges that match it (see findJoinMatch())
+                    bool isJoin = !isAnchored;
+                    tested = (isTyped || isJoin) ? stats.windowEdges * selectivity : stats.windowEdges;
+                    numExtensions = stats.windowEdges * selectivity / 2;
+                    access[h_i] = isJoin ? "join list" : (isTyped ? "typed list" : "scan");
+                }
+                cost += numPartials * tested;
+                numPartials *= numExtensions;
+            }
+            estMatches[h_i] = numPartials;
+            isMapped[hEdge.source()] = true;
+            isMapped[hEdge.dest()] = true;
+        }
+
+        // The matches have to be sorted afterward
+        if(isAnchored && numPartials > 1)
+            cost += numPartials * log2(numPartials);
+        return cost;
+    }
+}
+
+QueryPlan QueryPlan::create(const Graph &g, const Graph &h, const MatchCriteria &criteria, int startEdge, int delta, bool allowAnchor)
+{
+    QueryPlan plan;
+    int numQueryEdges = h.numEdges();
+    int m = g.numEdges();
+    for(int h_i=0; h_i<numQueryEdges; h_i++)
+        plan.order.push_back(h_i);
+    plan.actualMatches.assign(numQueryEdges, 0);
+    plan.pairLookups.assign(numQueryEdges, 0);
+    if(numQueryEdges == 0)
+        return plan;
+
+    SearchStats stats;
+    stats.numNodes = g.numNodes();
+    stats.numEdges = max(0, m - startEdge);
+    stats.windowEdges = stats.numEdges;
+    if(stats.numEdges > 0)
+    {
+        // Fraction of the edges within delta of an edge
+        double span = (double)(g.edges()[m-1].time() - g.edges()[startEdge].time());
+        if(span > delta)
+            stats.windowEdges *= (double)delta / span;
+    }
+    stats.windowDegree = stats.numNodes > 0 ? 2 * stats.windowEdges / stats.numNodes : 0;
+
+    // The graph's statistics know how many nodes actually have edges, and
+    // how busy the graph is over time.  If they're for the graph g was
+    // filtered from, g has a fraction of its edges, over about the same
+    // nodes and time.
+    const GraphStats *graphStats = g.stats();
+    if(graphStats != NULL && graphStats->numEdges >= m - g.firstEdge() && stats.numEdges > 0)
+    {
+        double fraction = (double)(m - g.firstEdge()) / graphStats->numEdges;
+        stats.windowEdges = min(stats.numEdges, graphStats->edgesPerSecond() * fraction * delta);
+        stats.windowDegree = graphStats->meanDegree() * fraction * stats.windowEdges / stats.numEdges;
+    }
+    for(int h_i=0; h_i<numQueryEdges; h_i++)
+    {
+        stats.numCandidates.push_back(estimateCandidates(g, h, criteria, h_i, startEdge));
+        stats.isTyped.push_back(criteria.candidateEdges(g, h, h_i) != NULL);
+    }
+    plan.estCandidates = stats.numCandidates;
+    plan.forwardCost = estimateCost(h, stats, plan.order, false, plan.estMatches, plan.access);
+    plan.cost = plan.forwardCost;
+    if(!allowAnchor)
+        return plan;
+
+    // Try starting from each of the other query edges
+    for(int anchor=1; anchor<numQueryEdges; anchor++)
+    {
+        vector<int> order;
+        for(int h_i=anchor; h_i>=0; h_i--)
+            order.push_back(h_i);
+        for(int h_i=anchor+1; h_i<numQueryEdges; h_i++)
+            order.push_back(h_i);
+        vector<double> estMatches;
+        vector<string> access;
+        double cost = estimateCost(h, stats, order, true, estMatches, access);
+        if(cost < plan.cost)
+        {
+            plan.strategy = ANCHORED;
+            plan.anchor = anchor;
+            plan.order = order;
+            plan.estMatches = estMatches;
+            plan.access = access;
+            plan.cost = cost;
+        }
+    }
+    return plan;
+}
+
+void QueryPlan::disp(const Graph &h) const
+{
+    cout << "Query plan: ";
+    if(strategy == ANCHORED)
+        cout << "anchored on query edge " << anchor << ", then backward and forward in time";
+    else
+        cout << "forward, in query edge order";
+    cout << " (estimated cost " << formatCount(cost) << ", forward " << formatCount(forwardCost) << ")" << endl;
+    cout << "  Step  Query edge  Access             Candidates  Est. matches  Actual" << endl;
+    for(int s=0; s<order.size(); s++)
+    {
+        int h_i = order[s];
+        const Edge &edge = h.edges()[h_i];
+        stringstream name;
+        name << h_i << " (" << edge.source() << "->" << edge.dest() << ")";
+        // (the search only knows whether the list of edges between two
+        // nodes was shorter once it's looked it up)
+        const string &how = pairLookups[h_i] > 0 ? "pair list" : access[h_i];
+        cout << "  " << left << setw(6) << s+1 << setw(12) << name.str() << setw(19) << how;
+        cout << right << setw(10) << formatCount(estCandidates[h_i]) << setw(14) << formatCount(estMatches[h_i]);
+        cout << setw(8) << actualMatches[h_i] << endl;
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef QUERY_PLAN_H
+#define QUERY_PLAN_H
+
+#include "Graph.h"
+#include "MatchCriteria.h"
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/**
+ * How an ordered search is going to match the query edges: which query edge
+ * it starts from (the first one, or a more selective "anchor"), the order
+ * the rest are matched in, and which list of edges in G each one is found
+ * from (the out/in edges of a node that's already mapped, the criteria's
+ * typed lists, a join list, or a scan of all the edges).  The cost of each
+ * strategy is estimated from how many edges match each query edge (from the
+ * criteria's lists, the graph's statistics, or a sample), the average degree
+ * of the nodes, and how many edges fall within delta of each other, and the
+ * cheapest one is used.  Join and typed lists never test more edges than a
+ * scan, so they're always used when there are any, not costed separately.  The actual number of partial matches
+ * is filled in by the search, so the estimates can be checked, along with
+ * how often it used the shorter list of edges between two mapped nodes.
+ */
+struct QueryPlan
+{
+public:
+    enum Strategy { FORWARD, ANCHORED };
+
+    QueryPlan() : strategy(FORWARD), anchor(0), cost(0), forwardCost(0) {}
+
+    /**
+     * Estimates the cost of each strategy for searching for h in g, and
+     * returns the cheapest.
+     * @param g  The directed graph to search on.
+     * @param h  The directed query graph we are trying to match.
+     * @param criteria  Determines whether edges match (already prepared for g and h).
+     * @param startEdge  First edge in g the matches can start at.
+     * @param delta  The max time duration allowed between edge matches.
+     * @param allowAnchor  If false, the query edges are always matched in order.
+     */
+    static QueryPlan create(const Graph &g, const Graph &h, const MatchCriteria &criteria, int startEdge, int delta, bool allowAnchor);
+
+    /** Prints the plan, with the estimated and actual number of partial
+     * matches after each query edge. */
+    void disp(const Graph &h) const;
+
+    Strategy strategy;
+    /** Query edge matched first */
+    int anchor;
+    /** Query edges, in the order they're matched */
+    std::vector<int> order;
+    /** How the edges in G are found for each query edge */
+    std::vector<std::string> access;
+    /** Estimated number of edges in G that match each query edge on its own */
+    std::vector<double> estCandidates;
+    /** Estimated and actual number of partial matches once each query edge is matched */
+    std::vector<double> estMatches;
+    std::vector<int64_t> actualMatches;
+    /** Number of times the search found each query edge's edges in the list
+     * of edges between its two mapped nodes, instead of their out/in lists */
+    std::vector<int64_t> pairLookups;
+    /** Estimated cost (edges tested) of the plan, and of matching the edges in order */
+    double cost, forwardCost;
+};
+
+#endif
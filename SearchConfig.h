@@ -11,7 +11,7 @@
 struct SearchConfig
 {
 public:
-    SearchConfig() : useStreaming(false), duration(0), delay(0), window(0), startDate(0), endDate(0) {} 
+    SearchConfig() : useStreaming(false), duration(0), delay(0), window(0), csvHeader(false), delta(0), startDate(0), endDate(0) {} 
     /** Only actually use streaming if this is set to true */
     bool useStreaming;
     /** The duration (sec) of data to pull down from the Mongo database for next streaming block of data */
@@ -20,6 +20,11 @@ public:
     time_t delay;
     /** The maximum time (sec) of data to hold in our graph we our analyzing. NOT to be confused with the delta value. */
     time_t window;
+    /** Columns of the CSV files to follow, as on a GDF "edgedef>" line (e.g.,
+     * "node1 VARCHAR, node2 VARCHAR, time INT"), or empty to only follow GDF files */
+    std::string csvColumns;
+    /** True if the first line of each CSV file is a header, instead of an edge */
+    bool csvHeader;
     /** Delta is the max duration (sec) to allow between edges in a matching subgraph. */
     time_t delta;
     /** List of unique node ID's that we want to find the subgraphs for. */
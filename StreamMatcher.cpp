@@ -0,0 +1,202 @@
+#include "StreamMatcher.h"
+#include <algorithm>
+
+using namespace std;
+
+StreamMatcher::StreamMatcher(const Graph &h, const MatchCriteria &criteria, int delta)
+{
+    _h = &h;
+    _criteria = &criteria;
+    _matchCriteria = &criteria;
+    _delta = delta;
+    _numNodes = h.numNodes();
+    _numEdges = h.numEdges();
+    _numPartials = 0;
+    _numStale = 0;
+
+    // Find which nodes each query edge shares with the ones before it
+    vector<bool> seen(_numNodes, false);
+    for(const Edge &edge : h.edges())
+    {
+        _boundSource.push_back(seen[edge.source()]);
+        _boundDest.push_back(seen[edge.dest()]);
+        seen[edge.source()] = true;
+        seen[edge.dest()] = true;
+    }
+    _indexes.resize(_numEdges);
+}
+
+int StreamMatcher::update(const Graph &g, vector<GraphMatch> &matches)
+{
+    if(_numEdges == 0)
+        return 0;
+    _preparedCriteria = _criteria->prepare(g, *_h);
+    _matchCriteria = _preparedCriteria ? _preparedCriteria.get() : _criteria;
+
+    int numMatches = matches.size();
+    int m = g.edges().size();
+    for(int e=_cursor.next(g); e<m; e++)
+        this->processEdge(g, e, matches);
+    _cursor.advance(g);
+    return matches.size() - numMatches;
+}
+
+void StreamMatcher::processEdge(const Graph &g, int e, vector<GraphMatch> &matches)
+{
+    const Edge &edge = g.edges()[e];
+    int u = edge.source(), v = edge.dest();
+
+    // Partial matches that are too old for this edge (or out of the window) can't be extended
+    time_t minTime = edge.time() - (time_t)_delta;
+    if(g.windowDuration() > 0)
+        minTime = max(minTime, g.windowStart());
+    this->expire(minTime);
+
+    // Latest states first, so the edge doesn't extend partial matches it just started
+    for(int i=_numEdges-1; i>=0; i--)
+    {
+        // Make sure if the edge is a self-loop or not
+        const Edge &hEdge = _h->edges()[i];
+        if((hEdge.source() == hEdge.dest()) != (u == v))
+            continue;
+
+        if(i == 0)
+        {
+            if(_matchCriteria->isEdgeMatch(g, e, *_h, 0))
+                this->extend(g, e, -1, matches);
+            continue;
+        }
+
+        auto iter = _indexes[i].find(this->key(i, u, v));
+        if(iter == _indexes[i].end() || !_matchCriteria->isEdgeMatch(g, e, *_h, i))
+            continue;
+        vector<pair<int,int>> &entries = iter->second;
+        int numKept = 0;
+        for(int j=0; j<entries.size(); j++)
+        {
+            int slot = entries[j].first;
+            if(_partialGens[slot] != entries[j].second)
+            {
+                // Dropped partial match
+                _numStale--;
+                continue;
+            }
+            entries[numKept++] = entries[j];
+
+            // Nodes that aren't in the partial match yet can't already be used by other query nodes
+            const int *nodes = &_partialNodes[slot * _numNodes];
+            if(!_boundSource[i] && find(nodes, nodes + _numNodes, u) != nodes + _numNodes)
+                continue;
+            if(!_boundDest[i] && find(nodes, nodes + _numNodes, v) != nodes + _numNodes)
+                continue;
+            this->extend(g, e, slot, matches);
+        }
+        entries.resize(numKept);
+        if(entries.empty())
+            _indexes[i].erase(iter);
+    }
+}
+
+void StreamMatcher::extend(const Graph &g, int e, int parent, vector<GraphMatch> &matches)
+{
+    const Edge &edge = g.edges()[e];
+    int state = parent < 0 ? 0 : _partialStates[parent];
+    const Edge &hEdge = _h->edges()[state];
+
+    // Last query edge, so it's a complete match
+    if(state + 1 == _numEdges)
+    {
+        GraphMatch match;
+        int64_t numRemoved = g.numRemovedEdges();
+        for(int i=0; i<state; i++)
+            match.addEdge(g.edges()[_partialEdges[parent * _numEdges + i] - numRemoved], _h->edges()[i]);
+        match.addEdge(edge, hEdge);
+        matches.push_back(match);
+        return;
+    }
+
+    // Reuse a dropped partial match's slot, if there is one
+    int slot;
+    if(_freeSlots.empty())
+    {
+        slot = _partialStates.size();
+        _partialStates.push_back(0);
+        _partialGens.push_back(0);
+        _partialTimes.push_back(0);
+        _partialNodes.resize(_partialNodes.size() + _numNodes);
+        _partialEdges.resize(_partialEdges.size() + _numEdges);
+    }
+    else
+    {
+        slot = _freeSlots.back();
+        _freeSlots.pop_back();
+    }
+
+    int *nodes = &_partialNodes[slot * _numNodes];
+    int64_t *edges = &_partialEdges[slot * _numEdges];
+    if(parent < 0)
+    {
+        fill(nodes, nodes + _numNodes, -1);
+        _partialTimes[slot] = edge.time();
+    }
+    else
+    {
+        copy_n(&_partialNodes[parent * _numNodes], _numNodes, nodes);
+        copy_n(&_partialEdges[parent * _numEdges], state, edges);
+        _partialTimes[slot] = _partialTimes[parent];
+    }
+    nodes[hEdge.source()] = edge.source();
+    nodes[hEdge.dest()] = edge.dest();
+    // (stored so it still works after old edges are evicted)
+    edges[state] = e + g.numRemovedEdges();
+    _partialStates[slot] = state + 1;
+    _numPartials++;
+
+    // Wait for the next query edge
+    const Edge &next = _h->edges()[state + 1];
+    _indexes[state + 1][this->key(state + 1, nodes[next.source()], nodes[next.dest()])].push_back(make_pair(slot, _partialGens[slot]));
+    _expiry.push(make_pair(_partialTimes[slot], slot));
+}
+
+uint64_t StreamMatcher::key(int state, int source, int dest) const
+{
+    int a = _boundSource[state] ? source : -1;
+    int b = _boundDest[state] ? dest : -1;
+    return ((uint64_t)(uint32_t)a << 32) | (uint32_t)b;
+}
+
+void StreamMatcher::expire(time_t minTime)
+{
+    while(!_expiry.empty() && _expiry.top().first < minTime)
+    {
+        int slot = _expiry.top().second;
+        _expiry.pop();
+        // The index entries are removed later
+        _partialGens[slot]++;
+        _partialStates[slot] = -1;
+        _freeSlots.push_back(slot);
+        _numPartials--;
+        _numStale++;
+    }
+
+    // Don't let the indexes fill up with entries for dropped partial matches
+    const int MIN_STALE = 1024;
+    if(_numStale > MIN_STALE && _numStale > _numPartials)
+        this->rebuildIndexes();
+}
+
+void StreamMatcher::rebuildIndexes()
+{
+    for(auto &index : _indexes)
+        index.clear();
+    for(int slot=0; slot<_partialStates.size(); slot++)
+    {
+        int state = _partialStates[slot];
+        if(state < 0)
+            continue;
+        const int *nodes = &_partialNodes[slot * _numNodes];
+        const Edge &next = _h->edges()[state];
+        _indexes[state][this->key(state, nodes[next.source()], nodes[next.dest()])].push_back(make_pair(slot, _partialGens[slot]));
+    }
+    _numStale = 0;
+}
@@ -0,0 +1,100 @@
+#ifndef STREAM_MATCHER_H
+#define STREAM_MATCHER_H
+
+#include "EdgeCursor.h"
+#include "Graph.h"
+#include "GraphMatch.h"
+#include "MatchCriteria.h"
+#include <stdint.h>
+#include <time.h>
+#include <limits.h>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/**
+ * Finds ordered subgraph matches as the edges arrive, instead of searching
+ * the graph again.  The query's edges (in chronological order) are the
+ * states of a state machine: a partial match in state i has matched query
+ * edges 0 to i-1, and is waiting for an edge that matches query edge i.
+ * For each state, the partial matches are kept in a hash index by the data
+ * nodes that query edge i has to connect (the ones it shares with the
+ * earlier query edges), so each new edge is only joined with the partial
+ * matches it can actually extend.  Partial matches are never used up (an
+ * edge can extend the same partial match as an earlier one), but they're
+ * dropped once they're older than delta, or their first edge is out of the
+ * graph's window, using a queue ordered by the time of their first edge.
+ *
+ * The matches found are the same ones findOrderedSubgraphs() finds, in a
+ * different order.  Edges are expected to arrive (roughly) in chronological
+ * order (see EdgeCursor).
+ */
+class StreamMatcher
+{
+public:
+    /**
+     * @param h  The query graph (which must stay around as long as this does).
+     * @param criteria  Determines whether edges match (must also stay around).
+     * @param delta  The max time duration allowed between edge matches.
+     */
+    StreamMatcher(const Graph &h, const MatchCriteria &criteria, int delta = INT_MAX);
+    /**
+     * Runs the edges added to the graph since the last update through the
+     * state machine, in chronological order.
+     * @param g  The data graph.
+     * @param matches  Any matches completed by the new edges are added to this.
+     * @return  The number of matches found.
+     */
+    int update(const Graph &g, std::vector<GraphMatch> &matches);
+    /** Number of partial matches waiting for more edges */
+    int numPartialMatches() const { return _numPartials; }
+
+private:
+    /** Joins the edge with the partial matches waiting for it */
+    void processEdge(const Graph &g, int e, std::vector<GraphMatch> &matches);
+    /** Adds the edge to a partial match (or starts one, if parent < 0),
+     * and either stores the result or adds it to matches, if it's complete. */
+    void extend(const Graph &g, int e, int parent, std::vector<GraphMatch> &matches);
+    /** Key in the index of the given state, for an edge between the given data
+     * nodes (only the nodes the earlier query edges have are used) */
+    uint64_t key(int state, int source, int dest) const;
+    /** Drops the partial matches that started before the given time */
+    void expire(time_t minTime);
+    /** Rebuilds the indexes without the entries for dropped partial matches */
+    void rebuildIndexes();
+
+    const Graph *_h;
+    const MatchCriteria *_criteria;
+    // Criteria prepared for the graph in the last update, if any, and the
+    // one to test the edges with
+    std::unique_ptr<MatchCriteria> _preparedCriteria;
+    const MatchCriteria *_matchCriteria;
+    int _delta;
+    int _numNodes, _numEdges;
+    // For each query edge, whether its nodes are in the earlier query edges
+    std::vector<bool> _boundSource, _boundDest;
+
+    // Partial matches, stored in slots that get reused once they're dropped:
+    // data node of each query node (or -1), and (evicted + index of) each edge matched
+    std::vector<int> _partialNodes;
+    std::vector<int64_t> _partialEdges;
+    // State, time of the first edge, and generation (which changes when the slot is reused)
+    std::vector<int> _partialStates, _partialGens;
+    std::vector<time_t> _partialTimes;
+    std::vector<int> _freeSlots;
+    int _numPartials;
+    // For each state, the (slot, generation) of its partial matches, by key
+    std::vector<std::unordered_map<uint64_t,std::vector<std::pair<int,int>>>> _indexes;
+    // Number of index entries for partial matches that have been dropped
+    int _numStale;
+    // Time of the first edge and slot of each partial match, earliest on top
+    std::priority_queue<std::pair<time_t,int>, std::vector<std::pair<time_t,int>>,
+                        std::greater<std::pair<time_t,int>>> _expiry;
+    // Edges processed so far
+    EdgeCursor _cursor;
+};
+
+#endif
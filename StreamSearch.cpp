@@ -0,0 +1,189 @@
+#include "StreamSearch.h"
+#include "FileIO.h"
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <set>
+#include <thread>
+#include <unordered_map>
+
+using namespace std;
+
+StreamSearch::StreamSearch(const SearchConfig &config, const string &sourcePath,
+                           const vector<string> &queryFnames, const string &infoFname, time_t delta)
+    : _config(config), _infoFname(infoFname), _delta(delta), _tail(sourcePath, config.csvColumns, config.csvHeader), _g((int)config.window)
+{
+    _started = false;
+    _rangeStart = 0;
+    _rangeEnd = 0;
+    _numCycles = 0;
+    _numLate = 0;
+    _lastMs = 0;
+    _totalMs = 0;
+    _maxMs = 0;
+    // (edges are copied into the window by their nodes' names, so the nodes
+    // that have left the window can go)
+    _g.setRemoveIdleNodes(true);
+
+    // The counters point to the queries, so they all have to be loaded first
+    for(const string &fname : queryFnames)
+    {
+        cout << "Loading query graph from " << fname << endl;
+        _queryNames.push_back(FileIO::getFname(fname));
+        _queries.push_back(FileIO::loadGenericGDF(fname));
+        cout << _queries.back().nodes().size() << " nodes, " << _queries.back().edges().size() << " edges" << endl;
+    }
+    for(int i=0; i<_queries.size(); i++)
+    {
+        _counters.push_back(MatchCounter(_queries[i], _criteria, (int)_delta));
+        if(_queryNames[i] == _config.find_subgraphs_query)
+            _selMatcher.reset(new StreamMatcher(_queries[i], _criteria, (int)_delta));
+    }
+    if(!_config.find_subgraphs_query.empty() && !_selMatcher)
+        cout << "The query to find subgraphs for (" << _config.find_subgraphs_query << ") isn't one of the queries." << endl;
+}
+
+void StreamSearch::run()
+{
+    cout << "Streaming: " << _config.duration << " sec of data every " << _config.delay << " sec, ";
+    cout << "with a window of " << _config.window << " sec" << endl;
+    while(this->cycle())
+    {
+        // Wait for the rest of the delay (the cycle already used part of it)
+        double waitMs = _config.delay * 1000.0 - _lastMs;
+        if(waitMs > 0)
+            this_thread::sleep_for(chrono::duration<double,milli>(waitMs));
+    }
+    cout << "Reached the end date." << endl;
+}
+
+bool StreamSearch::cycle()
+{
+    auto startTime = chrono::steady_clock::now();
+
+    _tail.poll(_incoming);
+    const EdgeList &incoming = _incoming.edges();
+    if(!_started && !incoming.empty())
+    {
+        // Start at the config's start date, or wherever the data starts
+        _rangeStart = _config.startDate > 0 ? _config.startDate : incoming.front().time();
+        _rangeEnd = _rangeStart;
+        _started = true;
+
+        for(const DataGraph &h : _queries)
+        {
+            if(h.nodeAttributesDef() != _incoming.nodeAttributesDef())
+                throw "Node attribute definitions don't match between the query graph and data graph.";
+            if(h.edgeAttributesDef() != _incoming.edgeAttributesDef())
+                throw "Edge attribute definitions don't match between the query graph and data graph.";
+        }
+        _g.setNodeAttributesDef(_incoming.nodeAttributesDef());
+        _g.setEdgeAttributesDef(_incoming.edgeAttributesDef());
+    }
+
+    bool more = true;
+    if(_started)
+    {
+        // Next block of data (or everything that's arrived, if there's no duration)
+        time_t end = _rangeEnd + _config.duration;
+        if(_config.duration <= 0)
+            end = incoming.empty() ? _rangeEnd : max(_rangeEnd, incoming.back().time() + 1);
+        if(_config.endDate > 0 && end >= _config.endDate)
+        {
+            end = _config.endDate;
+            more = false;
+        }
+        this->ingest(end);
+        _rangeEnd = end;
+
+        unordered_map<string,int> counts;
+        if(!_g.edges().empty())
+        {
+            _g.evictOldEdges();
+            for(int i=0; i<_counters.size(); i++)
+            {
+                _counters[i].update(_g);
+                counts[_queryNames[i]] = (int)_counters[i].count();
+            }
+            if(_selMatcher)
+            {
+                vector<GraphMatch> matches;
+                _selMatcher->update(_g, matches);
+                this->addSelectedLinks(matches);
+            }
+        }
+
+        // Links of selected matches that have left the window
+        time_t windowStart = _rangeStart;
+        if(_config.window > 0 && !_g.edges().empty())
+            windowStart = max(_rangeStart, _g.windowStart());
+        while(!_selLinks.empty() && _selLinks.front().first < windowStart)
+            _selLinks.pop_front();
+        set<pair<string,string>> uniqueLinks;
+        for(const auto &link : _selLinks)
+            uniqueLinks.insert(link.second);
+        vector<pair<string,string>> selEdges(uniqueLinks.begin(), uniqueLinks.end());
+
+        FileIO::saveGraphInfo(_g, windowStart, _rangeEnd, counts, _config, selEdges, _infoFname);
+    }
+
+    _lastMs = chrono::duration<double,milli>(chrono::steady_clock::now() - startTime).count();
+    this->dispLatency(_lastMs);
+    return more;
+}
+
+void StreamSearch::ingest(time_t end)
+{
+    // Anything before the end of the last block has either been ingested
+    // already, or showed up too late to be (just like EdgeCursor)
+    const EdgeList &edges = _incoming.edges();
+    auto isEarlier = [](const Edge &e, time_t t) { return e.time() < t; };
+    int first = lower_bound(edges.begin(), edges.end(), _rangeEnd, isEarlier) - edges.begin();
+    int last = lower_bound(edges.begin() + first, edges.end(), end, isEarlier) - edges.begin();
+    for(int e=first; e<last; e++)
+        _g.copyEdge(e, _incoming);
+    _incoming.evictEdgesBefore(end);
+}
+
+void StreamSearch::addSelectedLinks(const vector<GraphMatch> &matches)
+{
+    const EdgeList &edges = _g.edges();
+    int numLinks = _selLinks.size();
+    for(const GraphMatch &match : matches)
+    {
+        // Only the matches with one of the given nodes (or all of them, if none are given)
+        bool selected = _config.find_subgraphs_nodes.empty();
+        for(int i=0; i<_config.find_subgraphs_nodes.size() && !selected; i++)
+        {
+            for(int v : match.nodes())
+            {
+                if(_g.getName(v) == _config.find_subgraphs_nodes[i])
+                {
+                    selected = true;
+                    break;
+                }
+            }
+        }
+        if(!selected)
+            continue;
+
+        time_t startTime = edges[match.edges().front()].time();
+        for(int e : match.edges())
+            _selLinks.push_back(make_pair(startTime, make_pair(_g.getName(edges[e].source()), _g.getName(edges[e].dest()))));
+    }
+    // The matches aren't found in order of their start times
+    sort(_selLinks.begin() + numLinks, _selLinks.end());
+    inplace_merge(_selLinks.begin(), _selLinks.begin() + numLinks, _selLinks.end());
+}
+
+void StreamSearch::dispLatency(double ms)
+{
+    _numCycles++;
+    _totalMs += ms;
+    _maxMs = max(_maxMs, ms);
+    if(_config.delay > 0 && ms > _config.delay * 1000.0)
+        _numLate++;
+    cout << "Cycle " << _numCycles << ": " << _g.numEdges() - _g.firstEdge() << " edges in window, ";
+    cout << ms << " ms (mean " << _totalMs / _numCycles << " ms, max " << _maxMs << " ms, ";
+    cout << _numLate << " over the delay)" << endl;
+}
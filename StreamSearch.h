@@ -0,0 +1,80 @@
+#ifndef STREAM_SEARCH_H
+#define STREAM_SEARCH_H
+
+#include "DataGraph.h"
+#include "GdfTail.h"
+#include "MatchCounter.h"
+#include "MatchCriteria_DataGraph.h"
+#include "SearchConfig.h"
+#include "StreamMatcher.h"
+#include <time.h>
+#include <deque>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * Drives the real-time search described by the streaming config.  Every
+ * config.delay seconds it ingests the next config.duration of data from a
+ * GDF source (a file or folder that keeps growing, see GdfTail), moves the
+ * graph's window forward (config.window), updates the counts of each query
+ * incrementally, and saves the GraphInfo JSON file.  How long each cycle
+ * takes is reported, so the window can be sized to keep up with the delay.
+ */
+class StreamSearch
+{
+public:
+    /**
+     * @param config  The streaming settings (see FileIO::loadConfig()).
+     * @param sourcePath  GDF file or folder that the data is appended to.
+     * @param queryFnames  GDF files of the queries to keep counts for.
+     * @param infoFname  Name of the GraphInfo JSON file to save after each cycle.
+     * @param delta  The max time duration allowed between edge matches.
+     */
+    StreamSearch(const SearchConfig &config, const std::string &sourcePath,
+                 const std::vector<std::string> &queryFnames, const std::string &infoFname, time_t delta);
+    /**
+     * Runs cycles until the config's end date is reached (or forever, if it
+     * doesn't have one), waiting for the rest of the delay after each one.
+     */
+    void run();
+    /**
+     * Ingests the next block of data, updates the counts and saves the info file.
+     * @return True if there may be more data to come (i.e., not past the end date).
+     */
+    bool cycle();
+
+private:
+    /** Copies the edges in the incoming graph before the given time to the windowed graph */
+    void ingest(time_t end);
+    /** Adds the links of the new selected query matches that have one of the config's nodes */
+    void addSelectedLinks(const std::vector<GraphMatch> &matches);
+    /** Adds the latency of a cycle to the stats, and prints them */
+    void dispLatency(double ms);
+
+    SearchConfig _config;
+    std::string _infoFname;
+    time_t _delta;
+    GdfTail _tail;
+    // Everything read from the source that hasn't been ingested yet
+    DataGraph _incoming;
+    // The data in the current window
+    DataGraph _g;
+    std::vector<std::string> _queryNames;
+    std::vector<DataGraph> _queries;
+    MatchCriteria_DataGraph _criteria;
+    std::vector<MatchCounter> _counters;
+    // Finds the matches of config.find_subgraphs_query, if it's one of the queries
+    std::unique_ptr<StreamMatcher> _selMatcher;
+    // Links of the selected matches (with the time of the match's first edge)
+    std::deque<std::pair<time_t,std::pair<std::string,std::string>>> _selLinks;
+    // Time range ingested so far
+    bool _started;
+    time_t _rangeStart, _rangeEnd;
+    // Cycle latency stats (ms)
+    int _numCycles, _numLate;
+    double _lastMs, _totalMs, _maxMs;
+};
+
+#endif
@@ -0,0 +1,53 @@
+#include "TypeDictionary.h"
+
+using namespace std;
+
+TypeDictionary::TypeDictionary()
+{
+    // Blank type is always 0
+    _names.push_back("");
+    _ids[""] = 0;
+}
+
+TypeDictionary &TypeDictionary::instance()
+{
+    static TypeDictionary dict;
+    return dict;
+}
+
+int TypeDictionary::id(const string &type)
+{
+    TypeDictionary &dict = instance();
+    lock_guard<mutex> guard(dict._lock);
+    auto iter = dict._ids.find(type);
+    if(iter != dict._ids.end())
+        return iter->second;
+    int id = dict._names.size();
+    dict._names.push_back(type);
+    dict._ids[type] = id;
+    return id;
+}
+
+int TypeDictionary::find(const string &type)
+{
+    TypeDictionary &dict = instance();
+    lock_guard<mutex> guard(dict._lock);
+    auto iter = dict._ids.find(type);
+    if(iter == dict._ids.end())
+        return -1;
+    return iter->second;
+}
+
+const string &TypeDictionary::name(int id)
+{
+    TypeDictionary &dict = instance();
+    lock_guard<mutex> guard(dict._lock);
+    return dict._names[id];
+}
+
+int TypeDictionary::size()
+{
+    TypeDictionary &dict = instance();
+    lock_guard<mutex> guard(dict._lock);
+    return dict._names.size();
+}
@@ -0,0 +1,43 @@
+#ifndef TYPE_DICTIONARY_H
+#define TYPE_DICTIONARY_H
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * Maps node and edge type names (e.g., "email", "pc") to small integer IDs.
+ * There's one dictionary shared by every graph, so IDs from a data graph 
+ * and a query graph can be compared directly.  The blank type ("") is 
+ * always ID 0.  It's locked, since graphs can still be loaded (adding new
+ * types) while other threads search frozen graphs.
+ */
+class TypeDictionary
+{
+public:
+    /** Bit used in type masks for types with IDs that don't get their own bit */
+    static const int OVERFLOW_BIT = 63;
+
+    /** Returns the ID of the given type, adding it if it's new */
+    static int id(const std::string &type);
+    /** Returns the ID of the given type, or -1 if it has never been used */
+    static int find(const std::string &type);
+    /** Returns the name of the type with the given ID */
+    static const std::string &name(int id);
+    /** Number of types in the dictionary */
+    static int size();
+    /** Bit that represents the given type in a 64-bit type mask */
+    static int maskBit(int id) { return id < OVERFLOW_BIT ? id : OVERFLOW_BIT; }
+
+private:
+    static TypeDictionary &instance();
+    TypeDictionary();
+
+    // (a deque, so the names returned by name() don't move when more are added)
+    std::deque<std::string> _names;
+    std::unordered_map<std::string,int> _ids;
+    std::mutex _lock;
+};
+
+#endif
@@ -5,7 +5,12 @@
 #include "FileIO.h"
 #include "GraphFilter.h"
 #include "GraphSearch.h"
+#include "GraphStats.h"
 #include "MatchCriteria_DataGraph.h"
+#include "NodeOrder.h"
+#include "OrderBenchmark.h"
+#include "SearchConfig.h"
+#include "StreamSearch.h"
 
 using namespace std;
 
@@ -21,13 +26,67 @@ int main(int argc, char **argv)
         // Largest graph to display on console (for testing purposes)
 	const int MAX_NUM_EDGES_FOR_DISP = 50;
 
+	// Stream the data in, instead of loading it all at once
+	if(!args.configFname().empty())
+	{
+	    cout << "Loading streaming config from " << args.configFname() << endl;
+	    SearchConfig config;
+	    FileIO::loadConfig(args.configFname(), config);
+	    string infoFname = args.outFname().empty() ? "GraphInfo.json" : args.outFname();
+	    time_t delta = config.delta > 0 ? config.delta : args.deltaValues()[0];
+	    StreamSearch search(config, args.graphFname(), args.queryFnames(), infoFname, delta);
+	    search.run();
+	    cout << "Done!\n" << endl;
+	    return 0;
+	}
+
 	cout << "Loading data graph from " << args.graphFname() << endl;
-	DataGraph g = FileIO::loadGenericGDF(args.graphFname());
+	DataGraph g = FileIO::isSnapshot(args.graphFname()) ?
+	    FileIO::loadSnapshot(args.graphFname()) : FileIO::loadGenericGDF(args.graphFname());
         cout << g.nodes().size() << " nodes, " << g.edges().size() << " edges" << endl;
 	if(g.numEdges() < MAX_NUM_EDGES_FOR_DISP)
 	    g.disp();
 	cout << endl;
 
+	// Renumber the nodes, if asked to
+	if(!args.reorder().empty())
+	{
+	    cout << "Renumbering nodes (" << args.reorder() << " order)" << endl;
+	    g.renumberNodes(NodeOrder::compute(g, NodeOrder::parse(args.reorder())));
+	}
+
+	// Compare the node orders, if that's what was asked for
+	if(args.reorderBenchmark())
+	{
+	    OrderBenchmark::run(g, args.queryFnames(), args.deltaValues());
+	    cout << "Done!\n" << endl;
+	    return 0;
+	}
+
+	// Save the graph's statistics, if asked for
+	if(!args.statsFname().empty())
+	{
+	    cout << "Saving graph statistics to " << args.statsFname() << endl;
+	    if(g.stats() != NULL)
+	        FileIO::saveStatsReport(*g.stats(), args.statsFname());
+	    else
+	        FileIO::saveStatsReport(GraphStats::compute(g), args.statsFname());
+	    if(args.queryFnames().empty() && args.snapshotFname().empty())
+	    {
+	        cout << "Done!\n" << endl;
+	        return 0;
+	    }
+	}
+
+	// Just save the snapshot, if that's what was asked for
+	if(!args.snapshotFname().empty())
+	{
+	    cout << "Saving snapshot to " << args.snapshotFname() << endl;
+	    FileIO::saveSnapshot(g, args.snapshotFname());
+	    cout << "Done!\n" << endl;
+	    return 0;
+	}
+
         // Keeps track of the subgraph counts for each query and each delta value
         vector<vector<int>> queryDeltaCounts;
         
@@ -70,6 +129,8 @@ int main(int argc, char **argv)
                 GraphSearch search;
                 vector<GraphMatch> results = search.findOrderedSubgraphs(g2, h, criteria, limit, delta);
                 cout << results.size() << " matching subgraphs were found." << endl;
+                if(args.explain())
+                    search.plan().disp(h);
                 deltaCounts.push_back(results.size());
 
                 cout << "Creating combo graph of all matching subgraphs" << endl;